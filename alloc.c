@@ -0,0 +1,127 @@
+/**
+ * @file alloc.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-10
+ *
+ * Counting wrappers around malloc, realloc and free. Every allocation is
+ * charged to a subsystem so the program can report how many allocations
+ * and how many bytes each part of it is responsible for, and can check that
+ * nothing is allocated once the game reaches its steady state.
+ *
+ */
+#include "alloc.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/**
+ * Size of the header stored in front of every block. It holds the size of
+ * the block and is kept at 16 bytes so the memory handed out stays aligned
+ * for any type.
+ */
+#define HEADER_SIZE 16
+
+/** Names of the subsystems, in the order of the Subsystem enum */
+static const char *subsystemNames[ NUM_SUBSYSTEMS ] = { "lexicon", "index", "sessions" };
+
+/** The counters kept for one subsystem */
+typedef struct {
+    _Atomic long allocations;
+    _Atomic long frees;
+    _Atomic long liveBytes;
+    _Atomic long peakBytes;
+} AllocStats;
+
+/** The counters of every subsystem */
+static AllocStats stats[ NUM_SUBSYSTEMS ];
+
+/** Whether the steady state has begun */
+static _Atomic bool steady;
+
+/** Allocations made since the steady state began */
+static _Atomic long steadyAllocations;
+
+/**
+ * Adds bytes to the live total of a subsystem and raises its peak if needed.
+ *
+ * @param subsystem the subsystem being charged
+ * @param bytes the number of bytes added, may be negative
+ */
+static void charge( Subsystem subsystem, long bytes )
+{
+    long live = atomic_fetch_add( &stats[ subsystem ].liveBytes, bytes ) + bytes;
+
+    //raise the peak, retrying if another thread raised it first
+    long peak = atomic_load( &stats[ subsystem ].peakBytes );
+    while ( live > peak && !atomic_compare_exchange_weak( &stats[ subsystem ].peakBytes, &peak, live ) )
+        ;
+}
+
+/**
+ * Counts one allocation against a subsystem and the steady state.
+ *
+ * @param subsystem the subsystem being charged
+ */
+static void countAllocation( Subsystem subsystem )
+{
+    atomic_fetch_add( &stats[ subsystem ].allocations, 1 );
+    if ( atomic_load( &steady ) )
+        atomic_fetch_add( &steadyAllocations, 1 );
+}
+
+void *countedMalloc( Subsystem subsystem, size_t size )
+{
+    return countedRealloc( subsystem, NULL, size );
+}
+
+void *countedRealloc( Subsystem subsystem, void *ptr, size_t size )
+{
+    //step back to the real start of the block and recover its old size
+    char *block = ptr == NULL ? NULL : (char *) ptr - HEADER_SIZE;
+    size_t oldSize = block == NULL ? 0 : *(size_t *) block;
+
+    block = realloc( block, size + HEADER_SIZE );
+    if ( block == NULL ) {
+        fprintf( stderr, "Out of memory\n" );
+        exit( EXIT_FAILURE );
+    }
+
+    *(size_t *) block = size;
+    countAllocation( subsystem );
+    charge( subsystem, (long) size - (long) oldSize );
+
+    return block + HEADER_SIZE;
+}
+
+void countedFree( Subsystem subsystem, void *ptr )
+{
+    if ( ptr == NULL )
+        return;
+
+    char *block = (char *) ptr - HEADER_SIZE;
+    atomic_fetch_add( &stats[ subsystem ].frees, 1 );
+    charge( subsystem, -(long) *(size_t *) block );
+
+    free( block );
+}
+
+void beginSteadyState()
+{
+    atomic_store( &steadyAllocations, 0 );
+    atomic_store( &steady, true );
+}
+
+long steadyStateAllocations()
+{
+    return atomic_load( &steadyAllocations );
+}
+
+void printAllocStats( FILE *fp )
+{
+    fprintf( fp, "%-10s %12s %12s %12s %12s\n", "subsystem", "allocations", "frees", "live bytes", "peak bytes" );
+    for ( int i = 0; i < NUM_SUBSYSTEMS; i++ )
+        fprintf( fp, "%-10s %12ld %12ld %12ld %12ld\n", subsystemNames[ i ],
+                 atomic_load( &stats[ i ].allocations ), atomic_load( &stats[ i ].frees ),
+                 atomic_load( &stats[ i ].liveBytes ), atomic_load( &stats[ i ].peakBytes ) );
+    fprintf( fp, "steady-state allocations: %ld\n", steadyStateAllocations() );
+}
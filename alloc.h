@@ -0,0 +1,72 @@
+/**
+ * @file alloc.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-10
+ *
+ * Counting wrappers around malloc, realloc and free. Every allocation is
+ * charged to a subsystem so the program can report how many allocations
+ * and how many bytes each part of it is responsible for, and can check that
+ * nothing is allocated once the game reaches its steady state.
+ *
+ */
+#include <stdlib.h>
+#include <stdio.h>
+
+/** The parts of the program allocations are charged to */
+typedef enum {
+    ALLOC_LEXICON,
+    ALLOC_INDEX,
+    ALLOC_SESSION,
+    NUM_SUBSYSTEMS
+} Subsystem;
+
+/**
+ * Allocates size bytes charged to the given subsystem.
+ * Exits with an error if the memory cannot be allocated.
+ *
+ * @param subsystem the subsystem the memory belongs to
+ * @param size the number of bytes to allocate
+ * @return void* pointer to the allocated memory
+ */
+void *countedMalloc( Subsystem subsystem, size_t size );
+
+/**
+ * Resizes memory from countedMalloc, charged to the given subsystem.
+ * A NULL ptr behaves like countedMalloc.
+ * Exits with an error if the memory cannot be allocated.
+ *
+ * @param subsystem the subsystem the memory belongs to
+ * @param ptr the memory being resized, or NULL
+ * @param size the new size in bytes
+ * @return void* pointer to the resized memory
+ */
+void *countedRealloc( Subsystem subsystem, void *ptr, size_t size );
+
+/**
+ * Frees memory from countedMalloc or countedRealloc.
+ *
+ * @param subsystem the subsystem the memory belongs to
+ * @param ptr the memory being freed, may be NULL
+ */
+void countedFree( Subsystem subsystem, void *ptr );
+
+/**
+ * Marks the start of the steady state. Allocations made after this
+ * point are counted separately so they can be reported.
+ */
+void beginSteadyState();
+
+/**
+ * Returns the number of allocations made since beginSteadyState.
+ *
+ * @return long the number of steady-state allocations
+ */
+long steadyStateAllocations();
+
+/**
+ * Prints a table of allocations, frees, live bytes and peak bytes
+ * for every subsystem.
+ *
+ * @param fp the file the table is printed to
+ */
+void printAllocStats( FILE *fp );
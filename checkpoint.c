@@ -0,0 +1,226 @@
+/**
+ * @file checkpoint.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-14
+ *
+ * Saves the progress of a simulation to a file now and then, and picks it
+ * back up after the run is interrupted. A checkpoint holds which chunks of
+ * targets are done, the histogram of the games played in them, and the
+ * hint cache, so a resumed run neither replays finished chunks nor solves
+ * known states again. A checkpoint only resumes the list and mode it was
+ * taken on.
+ *
+ */
+#include "checkpoint.h"
+#include "hintcache.h"
+#include "lexicon.h"
+#include "metrics.h"
+#include "alloc.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/** Marks the start of a checkpoint file */
+#define CHECKPOINT_MAGIC "WCHKPT02"
+
+/** Number of bytes in CHECKPOINT_MAGIC */
+#define MAGIC_LEN 8
+
+/** Nanoseconds in a second */
+#define NANOS_PER_SECOND 1000000000L
+
+/** Added to the checkpoint's name for the file it is written to first */
+#define TEMP_SUFFIX ".tmp"
+
+/** The header at the start of a checkpoint file */
+typedef struct {
+    char magic[ MAGIC_LEN ];
+
+    /** The list the simulation ran on: its words, their length and its fingerprint */
+    int32_t words;
+    int32_t wordLen;
+    uint64_t fingerprint;
+
+    /** How the targets were split up, the longest game tracked, and whether it is hard mode */
+    int32_t chunkSize;
+    int32_t numChunks;
+    int32_t maxGuesses;
+    int32_t hard;
+
+    /** Number of hint cache entries after the histogram */
+    int64_t numHints;
+} CheckpointHeader;
+
+/** A hint cache entry as saved */
+typedef struct {
+    uint64_t key;
+    int64_t guess;
+} SavedHint;
+
+/**
+ * Fills in the header of a checkpoint of the list in use.
+ *
+ * @param header the header
+ * @param numChunks the number of chunks of targets
+ */
+static void describeList( CheckpointHeader *header, int numChunks )
+{
+    memset( header, 0, sizeof( *header ) );
+    memcpy( header->magic, CHECKPOINT_MAGIC, MAGIC_LEN );
+    header->words = lexiconSize();
+    header->wordLen = wordLength();
+    header->fingerprint = lexiconFingerprint( currentLexicon() );
+    header->chunkSize = SIMULATE_CHUNK;
+    header->numChunks = numChunks;
+    header->maxGuesses = MAX_SIM_GUESSES;
+    header->hard = isHardMode();
+}
+
+/**
+ * Reads a checkpoint into the progress and the hint cache, if it is one of
+ * this list split the same way.
+ *
+ * @param progress the progress, with nothing done
+ * @param path the checkpoint file
+ */
+static void loadCheckpoint( SimProgress *progress, char const path[] )
+{
+    FILE *fp = fopen( path, "rb" );
+    if ( fp == NULL )
+        return;
+
+    CheckpointHeader header, expected;
+    describeList( &expected, progress->numChunks );
+    if ( fread( &header, sizeof( header ), 1, fp ) != 1 || header.numHints < 0 ) {
+        fprintf( stderr, "Ignoring the invalid checkpoint %s\n", path );
+        fclose( fp );
+        return;
+    }
+
+    //everything but the number of hints must match
+    expected.numHints = header.numHints;
+    if ( memcmp( &header, &expected, sizeof( header ) ) != 0 ) {
+        fprintf( stderr, "Ignoring the checkpoint of another list or mode %s\n", path );
+        fclose( fp );
+        return;
+    }
+
+    //read the whole checkpoint before using any of it
+    uint8_t *done = countedMalloc( ALLOC_SESSION, progress->numChunks );
+    int64_t histogram[ MAX_SIM_GUESSES + 1 ];
+    bool ok = fread( done, 1, progress->numChunks, fp ) == progress->numChunks &&
+              fread( histogram, sizeof( int64_t ), MAX_SIM_GUESSES + 1, fp ) == MAX_SIM_GUESSES + 1;
+
+    if ( ok ) {
+        for ( int c = 0; c < progress->numChunks; c++ ) {
+            progress->done[ c ] = done[ c ] != 0;
+            progress->numDone += progress->done[ c ];
+        }
+        for ( int g = 0; g <= MAX_SIM_GUESSES; g++ )
+            progress->histogram[ g ] = histogram[ g ];
+
+        //a cut off list of hints is still good as far as it goes, and a damaged
+        //hint is skipped rather than let a guess index past the end of the list
+        SavedHint hint;
+        for ( long h = 0; h < header.numHints && fread( &hint, sizeof( hint ), 1, fp ) == 1; h++ )
+            if ( hint.key != 0 && hint.guess >= 0 && hint.guess < lexiconSize() )
+                storeHint( hint.key, hint.guess );
+        fprintf( stderr, "Resuming from %s with %d of %d chunks done\n", path, progress->numDone, progress->numChunks );
+    } else {
+        fprintf( stderr, "Ignoring the invalid checkpoint %s\n", path );
+    }
+
+    countedFree( ALLOC_SESSION, done );
+    fclose( fp );
+}
+
+void startProgress( SimProgress *progress, int numChunks, char const path[] )
+{
+    progress->numChunks = numChunks;
+    progress->numDone = 0;
+    progress->done = countedMalloc( ALLOC_SESSION, numChunks * sizeof( bool ) );
+    for ( int c = 0; c < numChunks; c++ )
+        progress->done[ c ] = false;
+    for ( int g = 0; g <= MAX_SIM_GUESSES; g++ )
+        progress->histogram[ g ] = 0;
+    progress->savedAt = monotonicNanos();
+
+    if ( path != NULL )
+        loadCheckpoint( progress, path );
+}
+
+void finishChunk( SimProgress *progress, int chunk, long const histogram[], char const path[] )
+{
+    progress->done[ chunk ] = true;
+    progress->numDone++;
+    for ( int g = 0; g <= MAX_SIM_GUESSES; g++ )
+        progress->histogram[ g ] += histogram[ g ];
+
+    if ( path != NULL && monotonicNanos() - progress->savedAt >= CHECKPOINT_SECONDS * NANOS_PER_SECOND )
+        saveCheckpoint( progress, path );
+}
+
+/** Where forEachHint writes hints to, and how many it has written */
+typedef struct {
+    FILE *fp;
+    int64_t count;
+} HintWriter;
+
+/**
+ * Writes one hint cache entry, for forEachHint.
+ *
+ * @param ctx the HintWriter
+ * @param key the key of the set
+ * @param guess its best guess
+ */
+static void writeHint( void *ctx, uint64_t key, int guess )
+{
+    HintWriter *writer = ctx;
+    SavedHint hint = { key, guess };
+    writer->count += fwrite( &hint, sizeof( hint ), 1, writer->fp );
+}
+
+void saveCheckpoint( SimProgress *progress, char const path[] )
+{
+    char *temp = countedMalloc( ALLOC_SESSION, strlen( path ) + sizeof( TEMP_SUFFIX ) );
+    strcpy( temp, path );
+    strcat( temp, TEMP_SUFFIX );
+
+    FILE *fp = fopen( temp, "wb" );
+    if ( fp == NULL ) {
+        fprintf( stderr, "Can't write the checkpoint: %s\n", temp );
+        countedFree( ALLOC_SESSION, temp );
+        return;
+    }
+
+    //the number of hints is only known once they are written, so the
+    //header is written again at the end
+    CheckpointHeader header;
+    describeList( &header, progress->numChunks );
+    fwrite( &header, sizeof( header ), 1, fp );
+    for ( int c = 0; c < progress->numChunks; c++ )
+        fputc( progress->done[ c ], fp );
+    for ( int g = 0; g <= MAX_SIM_GUESSES; g++ ) {
+        int64_t count = progress->histogram[ g ];
+        fwrite( &count, sizeof( count ), 1, fp );
+    }
+
+    HintWriter writer = { fp, 0 };
+    forEachHint( writeHint, &writer );
+    header.numHints = writer.count;
+    fseek( fp, 0, SEEK_SET );
+    fwrite( &header, sizeof( header ), 1, fp );
+
+    //only a complete checkpoint replaces the last one
+    bool failed = ferror( fp );
+    failed = fclose( fp ) != 0 || failed;
+    if ( failed || rename( temp, path ) != 0 )
+        fprintf( stderr, "Can't write the checkpoint: %s\n", path );
+    progress->savedAt = monotonicNanos();
+    countedFree( ALLOC_SESSION, temp );
+}
+
+void freeProgress( SimProgress *progress )
+{
+    countedFree( ALLOC_SESSION, progress->done );
+}
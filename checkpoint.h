@@ -0,0 +1,74 @@
+/**
+ * @file checkpoint.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-14
+ *
+ * Saves the progress of a simulation to a file now and then, and picks it
+ * back up after the run is interrupted. A checkpoint holds which chunks of
+ * targets are done, the histogram of the games played in them, and the
+ * hint cache, so a resumed run neither replays finished chunks nor solves
+ * known states again. A checkpoint only resumes the list and mode it was
+ * taken on.
+ *
+ */
+#include "solver.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/** Seconds between checkpoints of a running simulation */
+#define CHECKPOINT_SECONDS 5
+
+/** How far a simulation has got */
+typedef struct {
+    /** Number of chunks of targets, and whether each is done */
+    int numChunks;
+    bool *done;
+
+    /** Number of chunks done */
+    int numDone;
+
+    /** Games played in the done chunks, by number of guesses */
+    long histogram[ MAX_SIM_GUESSES + 1 ];
+
+    /** When the last checkpoint was saved, by monotonicNanos */
+    long savedAt;
+} SimProgress;
+
+/**
+ * Starts the progress of a simulation with nothing done, then picks up
+ * where a checkpoint left off if path holds one for this list.
+ *
+ * @param progress the progress
+ * @param numChunks the number of chunks of targets
+ * @param path the checkpoint file, or NULL for none
+ */
+void startProgress( SimProgress *progress, int numChunks, char const path[] );
+
+/**
+ * Marks a chunk done and adds its games to the histogram, saving a
+ * checkpoint if CHECKPOINT_SECONDS have passed since the last one.
+ *
+ * @param progress the progress
+ * @param chunk the chunk
+ * @param histogram the games played in the chunk, by number of guesses
+ * @param path the checkpoint file, or NULL for none
+ */
+void finishChunk( SimProgress *progress, int chunk, long const histogram[], char const path[] );
+
+/**
+ * Saves a checkpoint of the progress and the hint cache. It is written
+ * next to path first and renamed over it, so an interrupted save leaves
+ * the last checkpoint whole.
+ *
+ * @param progress the progress
+ * @param path the checkpoint file
+ */
+void saveCheckpoint( SimProgress *progress, char const path[] );
+
+/**
+ * Frees the memory of the progress.
+ *
+ * @param progress the progress
+ */
+void freeProgress( SimProgress *progress );
@@ -0,0 +1,223 @@
+/**
+ * @file complete.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-23
+ *
+ * As-you-type completion of guesses for players at a terminal. While a
+ * guess is being typed, the number of words in the sorted lexicon that
+ * start with it and the first few of them are shown next to it, and Tab
+ * fills in the first one. Completed lines are handed back one character
+ * at a time so the game reads them the same way it reads stdin.
+ *
+ */
+#include "complete.h"
+#include "lexicon.h"
+#include "io.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <termios.h>
+
+/** Most characters kept of a line being typed */
+#define LINE_CAPACITY 64
+
+/** Character the terminal sends for Tab */
+#define TAB_KEY '\t'
+
+/** Characters the terminal may send for Backspace */
+#define BACKSPACE_KEY 0x7f
+#define CTRL_H_KEY 0x08
+
+/** Character the terminal sends for Ctrl-D */
+#define CTRL_D_KEY 0x04
+
+/** Character that starts the sequences the terminal sends for arrows and other keys */
+#define ESCAPE_KEY 0x1b
+
+/** Bytes ending a control sequence of the form ESC [ ... */
+#define SEQUENCE_FINAL_FIRST 0x40
+#define SEQUENCE_FINAL_LAST 0x7e
+
+/** The terminal settings from before completion started */
+static struct termios savedSettings;
+
+/** The line typed so far, followed by a line-feed once it is finished */
+static char line[ LINE_CAPACITY + 2 ];
+
+/** The number of characters in line */
+static int lineLen;
+
+/** The next character of line to hand out */
+static int linePos;
+
+/**
+ * Puts the terminal back the way it was before completion started.
+ */
+static void restoreTerminal()
+{
+    tcsetattr( STDIN_FILENO, TCSANOW, &savedSettings );
+}
+
+/**
+ * Puts the terminal back when the game is interrupted or terminated,
+ * then lets the signal end the game as it would have. Exit handlers do
+ * not run when a signal kills the process.
+ *
+ * @param sig the signal
+ */
+static void restoreOnSignal( int sig )
+{
+    restoreTerminal();
+    raise( sig );
+}
+
+/**
+ * Reads and drops the rest of the sequence a key like an arrow sends, after
+ * its ESC, so none of it ends up in the guess.
+ */
+static void skipEscapeSequence()
+{
+    unsigned char key;
+    if ( read( STDIN_FILENO, &key, 1 ) != 1 )
+        return;
+
+    //ESC O and one more byte, or ESC [ and parameters up to a final byte
+    if ( key == 'O' ) {
+        if ( read( STDIN_FILENO, &key, 1 ) != 1 )
+            return;
+    } else if ( key == '[' ) {
+        while ( read( STDIN_FILENO, &key, 1 ) == 1 )
+            if ( key >= SEQUENCE_FINAL_FIRST && key <= SEQUENCE_FINAL_LAST )
+                return;
+    }
+}
+
+/**
+ * Redraws the line being typed followed by its completions, then moves the
+ * cursor back to the end of the typed letters. Writes the whole redraw in
+ * one call so the terminal never shows half of it.
+ */
+static void redraw()
+{
+    char out[ LINE_CAPACITY * 4 + ( MAX_WORD_LEN + 1 ) * SHOWN_COMPLETIONS ];
+    int len = 0;
+
+    //return to the start of the line, print what was typed and clear the rest
+    line[ lineLen ] = NULL_TERMINATOR;
+    len += snprintf( out + len, sizeof( out ) - len, "\r%s\x1b[K", line );
+
+    //completions only make sense for a partial word
+    int first;
+    int count = lineLen > 0 && lineLen < wordLength() ? prefixRange( line, &first ) : 0;
+    if ( count > 0 ) {
+        int hintStart = len;
+        len += snprintf( out + len, sizeof( out ) - len, "  (%d:", count );
+        for ( int i = 0; i < count && i < SHOWN_COMPLETIONS; i++ )
+            len += snprintf( out + len, sizeof( out ) - len, " %s", lexiconWord( first + i ) );
+        len += snprintf( out + len, sizeof( out ) - len, "%s)", count > SHOWN_COMPLETIONS ? " ..." : "" );
+
+        //move the cursor back over the hint
+        len += snprintf( out + len, sizeof( out ) - len, "\x1b[%dD", len - hintStart );
+    }
+
+    if ( write( STDOUT_FILENO, out, len ) != len )
+        return;
+}
+
+/**
+ * Reads one line from the terminal a key at a time, redrawing the line and
+ * its completions after every key.
+ *
+ * @return true if a line was read
+ * @return false if the input ended first
+ */
+static bool readLineWithCompletion()
+{
+    lineLen = 0;
+    linePos = 0;
+
+    //anything printed by the game so far has to show up before the prompt
+    fflush( stdout );
+
+    unsigned char key;
+    while ( read( STDIN_FILENO, &key, 1 ) == 1 ) {
+
+        if ( key == '\n' || key == '\r' ) {
+            //clear the hint and finish the line
+            line[ lineLen ] = NULL_TERMINATOR;
+            if ( write( STDOUT_FILENO, "\x1b[K\n", 4 ) != 4 )
+                return false;
+            line[ lineLen++ ] = '\n';
+            return true;
+        }
+
+        if ( key == CTRL_D_KEY && lineLen == 0 )
+            return false;
+
+        if ( key == BACKSPACE_KEY || key == CTRL_H_KEY ) {
+            if ( lineLen > 0 )
+                lineLen--;
+        }
+
+        //arrows and other special keys are not part of a guess
+        else if ( key == ESCAPE_KEY ) {
+            skipEscapeSequence();
+            continue;
+        }
+
+        else if ( key == TAB_KEY ) {
+            //fill in the first word with the typed prefix
+            int first;
+            line[ lineLen ] = NULL_TERMINATOR;
+            if ( lineLen > 0 && prefixRange( line, &first ) > 0 ) {
+                strcpy( line, lexiconWord( first ) );
+                lineLen = strlen( line );
+            }
+        }
+
+        //everything else is part of the guess, the game decides if it is valid
+        else if ( lineLen < LINE_CAPACITY )
+            line[ lineLen++ ] = key;
+
+        redraw();
+    }
+
+    return false;
+}
+
+bool startCompletion()
+{
+    if ( !isatty( STDIN_FILENO ) || tcgetattr( STDIN_FILENO, &savedSettings ) != 0 )
+        return false;
+
+    //turn off line buffering and echo, the redraw shows what is typed
+    struct termios raw = savedSettings;
+    raw.c_lflag &= ~( ICANON | ECHO );
+    raw.c_cc[ VMIN ] = 1;
+    raw.c_cc[ VTIME ] = 0;
+    if ( tcsetattr( STDIN_FILENO, TCSANOW, &raw ) != 0 )
+        return false;
+
+    atexit( restoreTerminal );
+
+    //each handler is reset as it runs, so raising the signal again ends the game
+    struct sigaction action;
+    memset( &action, 0, sizeof( action ) );
+    action.sa_handler = restoreOnSignal;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset( &action.sa_mask );
+    sigaction( SIGINT, &action, NULL );
+    sigaction( SIGTERM, &action, NULL );
+    return true;
+}
+
+int completedGetc()
+{
+    if ( linePos == lineLen && !readLineWithCompletion() )
+        return EOF;
+
+    return (unsigned char) line[ linePos++ ];
+}
@@ -0,0 +1,35 @@
+/**
+ * @file complete.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-23
+ *
+ * As-you-type completion of guesses for players at a terminal. While a
+ * guess is being typed, the number of words in the sorted lexicon that
+ * start with it and the first few of them are shown next to it, and Tab
+ * fills in the first one. Completed lines are handed back one character
+ * at a time so the game reads them the same way it reads stdin.
+ *
+ */
+#include <stdbool.h>
+
+/** Number of completions shown next to the guess being typed */
+#define SHOWN_COMPLETIONS 3
+
+/**
+ * Switches the terminal into character-at-a-time mode so completions can
+ * be shown while typing. The terminal is restored when the program exits.
+ * Does nothing if stdin is not a terminal.
+ *
+ * @return true if completion is on
+ * @return false if stdin is not a terminal
+ */
+bool startCompletion();
+
+/**
+ * Returns the next character of input like getc( stdin ). When no typed
+ * line is waiting, reads a whole line from the terminal first, showing
+ * completions as it is typed.
+ *
+ * @return int the next character, or EOF at the end of input
+ */
+int completedGetc();
@@ -0,0 +1,333 @@
+/**
+ * @file cover.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-16
+ *
+ * Searches the lexicon for a set of opening words that together cover
+ * as many different letters as possible, or as many of the most frequent
+ * letters as possible. Words are reduced to 26-bit letter masks, words
+ * with identical masks are searched only once, and branches that cannot
+ * beat the best set found so far are pruned.
+ *
+ */
+#include "cover.h"
+#include "lexicon.h"
+#include "io.h"
+#include "alloc.h"
+#include "pool.h"
+
+#include <stdatomic.h>
+#include <string.h>
+#include <pthread.h>
+
+/** Number of letters in the alphabet */
+#define ALPHABET_SIZE 26
+
+/** A distinct letter mask and the first word that has it */
+typedef struct {
+    /** Bit n is set if the word contains the nth letter of the alphabet */
+    unsigned mask;
+
+    /** Sum of the weights of the letters in the mask */
+    long weight;
+
+    /** Index of the word in the lexicon */
+    int word;
+} Candidate;
+
+/** The distinct masks, heaviest first */
+static Candidate *candidates;
+
+/** The number of distinct masks */
+static int numCandidates;
+
+/** The number of words in a set */
+static int wordsPerSet;
+
+/** What each letter is worth when a set covers it */
+static long letterWeights[ ALPHABET_SIZE ];
+
+/** The letters from heaviest to lightest */
+static int lettersByWeight[ ALPHABET_SIZE ];
+
+/** Score of the best set found by any thread */
+static _Atomic long bestScore;
+
+/** Candidates in the best set found by any thread, guarded by bestLock */
+static int bestSet[ MAX_COVER_WORDS ];
+
+/** Guards bestSet while a thread records a better set */
+static pthread_mutex_t bestLock = PTHREAD_MUTEX_INITIALIZER;
+
+/** The next first candidate a thread should search from */
+static _Atomic int nextFirst;
+
+/**
+ * Adds up the weights of the letters in a mask.
+ *
+ * @param mask the letters being weighed
+ * @return long their total weight
+ */
+static long maskWeight( unsigned mask )
+{
+    long weight = 0;
+    while ( mask ) {
+        weight += letterWeights[ __builtin_ctz( mask ) ];
+        mask &= mask - 1;
+    }
+    return weight;
+}
+
+/**
+ * Bounds what count more letters can add to a set: no more than the
+ * count heaviest letters the set does not cover yet.
+ *
+ * @param used the letters the set already covers
+ * @param count the most letters the remaining words can add
+ * @return long the largest weight the remaining words can add
+ */
+static long unusedBound( unsigned used, int count )
+{
+    long bound = 0;
+    for ( int k = 0; k < ALPHABET_SIZE && count > 0; k++ ) {
+        if ( !( used & ( 1u << lettersByWeight[ k ] ) ) ) {
+            bound += letterWeights[ lettersByWeight[ k ] ];
+            count--;
+        }
+    }
+    return bound;
+}
+
+/**
+ * Records chosen as the best set if it still beats the best set
+ * found by every other thread.
+ *
+ * @param chosen the candidates in the set
+ * @param score the score of the set
+ */
+static void offerSet( int chosen[], long score )
+{
+    pthread_mutex_lock( &bestLock );
+    if ( score > atomic_load( &bestScore ) ) {
+        memcpy( bestSet, chosen, wordsPerSet * sizeof( int ) );
+        atomic_store( &bestScore, score );
+    }
+    pthread_mutex_unlock( &bestLock );
+}
+
+/**
+ * Narrows a list of candidates down to the ones that could still be part of
+ * a set that beats the best score. Nothing is kept if even the heaviest
+ * uncovered letters cannot beat it. A kept candidate may be chosen after
+ * heavier ones from the same list, so the other remaining slots are bounded
+ * by the heaviest candidate in the list, not by the candidate's own weight.
+ * Candidates are sorted heaviest first, so once a candidate cannot beat the
+ * best score even then, no later candidate can either and the scan stops.
+ *
+ * @param list the candidates being narrowed, heaviest first
+ * @param count the number of candidates in list
+ * @param used the letters covered by the words chosen so far
+ * @param score the weight of the covered letters
+ * @param left the number of words still to be chosen
+ * @param out where the remaining candidates are written
+ * @return int the number of candidates written to out
+ */
+static int narrow( int const list[], int count, unsigned used, long score, int left, int out[] )
+{
+    long best = atomic_load_explicit( &bestScore, memory_order_relaxed );
+    int kept = 0;
+    if ( count == 0 || score + unusedBound( used, left * WORD_LEN ) <= best )
+        return 0;
+
+    long heaviest = candidates[ list[ 0 ] ].weight;
+    for ( int k = 0; k < count; k++ ) {
+        Candidate const *c = &candidates[ list[ k ] ];
+        if ( score + c->weight + ( left - 1 ) * heaviest <= best )
+            break;
+
+        //this candidate adds too little, but a later one might still do
+        if ( score + maskWeight( c->mask & ~used ) + ( left - 1 ) * heaviest > best )
+            out[ kept++ ] = list[ k ];
+    }
+    return kept;
+}
+
+/**
+ * Depth-first search for the remaining words of a set. Each level only
+ * looks at the candidates its parent narrowed down, so words that overlap
+ * too much with the words already chosen are dropped once, not re-checked
+ * at every deeper level.
+ *
+ * @param list the candidates that may still be added, heaviest first
+ * @param count the number of candidates in list
+ * @param depth the number of words already chosen
+ * @param used the letters covered by the chosen words
+ * @param score the weight of the covered letters
+ * @param chosen the candidates chosen so far
+ * @param scratch one candidate list per depth for the narrowed lists
+ */
+static void extendSet( int const list[], int count, int depth, unsigned used, long score, int chosen[], int *scratch[] )
+{
+    if ( depth == wordsPerSet ) {
+        if ( score > atomic_load_explicit( &bestScore, memory_order_relaxed ) )
+            offerSet( chosen, score );
+        return;
+    }
+
+    int left = wordsPerSet - depth;
+    for ( int k = 0; k < count; k++ ) {
+        Candidate const *c = &candidates[ list[ k ] ];
+
+        //the best may have improved since the list was narrowed
+        long best = atomic_load_explicit( &bestScore, memory_order_relaxed );
+        if ( score + left * c->weight <= best )
+            break;
+        //c is chosen here, so every later word comes after it and is no heavier
+        long gain = maskWeight( c->mask & ~used );
+        if ( score + gain + ( left - 1 ) * c->weight <= best )
+            continue;
+
+        chosen[ depth ] = list[ k ];
+        int childCount = narrow( list + k + 1, count - k - 1, used | c->mask, score + gain, left - 1, scratch[ depth ] );
+        extendSet( scratch[ depth ], childCount, depth + 1, used | c->mask, score + gain, chosen, scratch );
+    }
+}
+
+/**
+ * Body of a search task, one per thread of the pool. Tasks take first
+ * words one at a time, heaviest first so the best set is found early and
+ * prunes the rest, and tasks that finish early pick up the remaining work.
+ *
+ * @param ctx the list of every candidate index, in order
+ * @param start unused
+ * @param end unused
+ */
+static void coverRange( void *ctx, long start, long end )
+{
+    int const *all = ctx;
+
+    //one narrowed list per depth, none can be longer than the candidate list
+    int *scratch[ MAX_COVER_WORDS ];
+    for ( int d = 0; d < wordsPerSet; d++ )
+        scratch[ d ] = countedMalloc( ALLOC_INDEX, numCandidates * sizeof( int ) );
+
+    int chosen[ MAX_COVER_WORDS ];
+    int first;
+    while ( ( first = atomic_fetch_add( &nextFirst, 1 ) ) <= numCandidates - wordsPerSet ) {
+        if ( wordsPerSet * candidates[ first ].weight <= atomic_load( &bestScore ) )
+            break;
+
+        chosen[ 0 ] = first;
+        int count = narrow( all + first + 1, numCandidates - first - 1, candidates[ first ].mask,
+                            candidates[ first ].weight, wordsPerSet - 1, scratch[ 0 ] );
+        extendSet( scratch[ 0 ], count, 1, candidates[ first ].mask, candidates[ first ].weight, chosen, scratch );
+    }
+
+    for ( int d = 0; d < wordsPerSet; d++ )
+        countedFree( ALLOC_INDEX, scratch[ d ] );
+}
+
+/**
+ * Orders candidates by mask so identical masks end up next to each other,
+ * keeping the alphabetically first word of each mask in front.
+ *
+ * @param a the first candidate
+ * @param b the second candidate
+ * @return int negative, zero or positive like strcmp
+ */
+static int compareMasks( void const *a, void const *b )
+{
+    Candidate const *x = a, *y = b;
+    if ( x->mask != y->mask )
+        return x->mask < y->mask ? -1 : 1;
+    return x->word - y->word;
+}
+
+/**
+ * Orders candidates heaviest first, which the pruning in extendSet relies on.
+ *
+ * @param a the first candidate
+ * @param b the second candidate
+ * @return int negative, zero or positive like strcmp
+ */
+static int compareWeights( void const *a, void const *b )
+{
+    Candidate const *x = a, *y = b;
+    if ( x->weight != y->weight )
+        return x->weight > y->weight ? -1 : 1;
+    return x->word - y->word;
+}
+
+void searchCover( FILE *out, int setSize, bool byFrequency )
+{
+    int n = lexiconSize();
+    if ( setSize > n ) {
+        fprintf( out, "The word list has fewer than %d words\n", setSize );
+        return;
+    }
+
+    //weigh every letter once, or by the number of times it appears in the lexicon
+    for ( int c = 0; c < ALPHABET_SIZE; c++ )
+        letterWeights[ c ] = byFrequency ? 0 : 1;
+    for ( int i = 0; byFrequency && i < n; i++ )
+        for ( int j = 0; j < WORD_LEN; j++ )
+            letterWeights[ lexiconWord( i )[ j ] - LOWERCASE_A ]++;
+
+    //order the letters heaviest first for unusedBound
+    for ( int c = 0; c < ALPHABET_SIZE; c++ ) {
+        int k = c;
+        while ( k > 0 && letterWeights[ lettersByWeight[ k - 1 ] ] < letterWeights[ c ] ) {
+            lettersByWeight[ k ] = lettersByWeight[ k - 1 ];
+            k--;
+        }
+        lettersByWeight[ k ] = c;
+    }
+
+    //reduce every word to its letter mask
+    candidates = countedMalloc( ALLOC_INDEX, n * sizeof( Candidate ) );
+    for ( int i = 0; i < n; i++ ) {
+        unsigned mask = 0;
+        for ( int j = 0; j < WORD_LEN; j++ )
+            mask |= 1u << ( lexiconWord( i )[ j ] - LOWERCASE_A );
+        candidates[ i ] = (Candidate) { mask, 0, i };
+    }
+
+    //keep one word per distinct mask, then weigh the masks
+    qsort( candidates, n, sizeof( Candidate ), compareMasks );
+    numCandidates = 0;
+    for ( int i = 0; i < n; i++ )
+        if ( numCandidates == 0 || candidates[ numCandidates - 1 ].mask != candidates[ i ].mask )
+            candidates[ numCandidates++ ] = candidates[ i ];
+    for ( int i = 0; i < numCandidates; i++ )
+        candidates[ i ].weight = maskWeight( candidates[ i ].mask );
+    qsort( candidates, numCandidates, sizeof( Candidate ), compareWeights );
+
+    wordsPerSet = setSize;
+    atomic_store( &bestScore, 0 );
+    atomic_store( &nextFirst, 0 );
+
+    //the top level list is every candidate
+    int *all = countedMalloc( ALLOC_INDEX, numCandidates * sizeof( int ) );
+    for ( int i = 0; i < numCandidates; i++ )
+        all[ i ] = i;
+
+    //one task per thread of the pool, each pulling first words until none are left
+    parallelFor( poolSize(), 1, coverRange, all );
+
+    if ( numCandidates < setSize ) {
+        fprintf( out, "The word list has fewer than %d distinct letter sets\n", setSize );
+    } else {
+        unsigned used = 0;
+        for ( int i = 0; i < setSize; i++ ) {
+            fprintf( out, "%s%s", i == 0 ? "" : " ", lexiconWord( candidates[ bestSet[ i ] ].word ) );
+            used |= candidates[ bestSet[ i ] ].mask;
+        }
+        fprintf( out, "\n%d distinct letters", __builtin_popcount( used ) );
+        if ( byFrequency )
+            fprintf( out, ", frequency weight %ld", atomic_load( &bestScore ) );
+        fprintf( out, "\n" );
+    }
+
+    countedFree( ALLOC_INDEX, all );
+    countedFree( ALLOC_INDEX, candidates );
+}
@@ -0,0 +1,28 @@
+/**
+ * @file cover.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-16
+ *
+ * Searches the lexicon for a set of opening words that together cover
+ * as many different letters as possible, or as many of the most frequent
+ * letters as possible. Words are reduced to 26-bit letter masks, words
+ * with identical masks are searched only once, and branches that cannot
+ * beat the best set found so far are pruned.
+ *
+ */
+#include <stdbool.h>
+#include <stdio.h>
+
+/** Largest number of words a covering set can have */
+#define MAX_COVER_WORDS 5
+
+/**
+ * Finds the set of setSize words from the sorted lexicon that covers the
+ * most letters, spread across all available cores, and prints it.
+ *
+ * @param out the file the set is printed to
+ * @param setSize the number of words in the set, between 1 and MAX_COVER_WORDS
+ * @param byFrequency if true, every letter counts as often as it appears
+ *                    in the lexicon; if false, every letter counts once
+ */
+void searchCover( FILE *out, int setSize, bool byFrequency );
@@ -0,0 +1,330 @@
+/**
+ * @file distsim.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-12
+ *
+ * Runs the simulation of a game against every word across worker
+ * processes. A coordinator splits the targets into chunks and hands them
+ * out one at a time over a local socket to each worker, which plays the
+ * chunk and sends back its histogram. A chunk held by a worker that dies,
+ * or that takes far longer than any chunk has before, goes back to be
+ * handed out again, and the histograms are merged as they come in. The
+ * messages are plain fixed-size records in the host's byte order, so
+ * workers could run on other machines only if those share its byte order.
+ *
+ */
+#include "distsim.h"
+#include "solver.h"
+#include "checkpoint.h"
+#include "lexicon.h"
+#include "alloc.h"
+#include "metrics.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/** Nanoseconds in a second and in a millisecond */
+#define NANOS_PER_SECOND 1000000000L
+#define NANOS_PER_MILLI 1000000L
+
+/** Least time a worker is given to play a chunk before it is taken to be hung */
+#define MIN_CHUNK_SECONDS 30
+
+/** A worker is also given this many times as long as the slowest chunk so far */
+#define CHUNK_TIME_FACTOR 20
+
+/** What a chunk of targets is up to */
+typedef enum { CHUNK_PENDING, CHUNK_RUNNING, CHUNK_DONE } ChunkState;
+
+/** Sent to a worker: play the targets from first to last - 1 */
+typedef struct {
+    int32_t first;
+    int32_t last;
+} ChunkRequest;
+
+/** Sent back by a worker: the chunk it played and how the games went */
+typedef struct {
+    int32_t first;
+    int32_t last;
+    int64_t histogram[ MAX_SIM_GUESSES + 1 ];
+} ChunkResult;
+
+/** A worker process as the coordinator sees it */
+typedef struct {
+    pid_t pid;
+
+    /** The coordinator's end of the socket to the worker */
+    int fd;
+
+    /** The chunk the worker is playing, or -1 if it is idle */
+    int chunk;
+
+    /** When the chunk was handed out, and when the worker is given up on */
+    long assignedAt;
+    long deadline;
+
+    bool alive;
+} Worker;
+
+/**
+ * Reads exactly size bytes, retrying after signals and short reads.
+ *
+ * @param fd the file descriptor read from
+ * @param buffer where the bytes are stored
+ * @param size the number of bytes
+ * @return true if every byte was read
+ * @return false if the other end closed or failed first
+ */
+static bool readFull( int fd, void *buffer, size_t size )
+{
+    char *bytes = buffer;
+    while ( size > 0 ) {
+        ssize_t got = read( fd, bytes, size );
+        if ( got < 0 && errno == EINTR )
+            continue;
+        if ( got <= 0 )
+            return false;
+        bytes += got;
+        size -= got;
+    }
+    return true;
+}
+
+/**
+ * Writes exactly size bytes, retrying after signals and short writes.
+ *
+ * @param fd the file descriptor written to
+ * @param buffer the bytes
+ * @param size the number of bytes
+ * @return true if every byte was written
+ * @return false if the other end closed or failed first
+ */
+static bool writeFull( int fd, void const *buffer, size_t size )
+{
+    char const *bytes = buffer;
+    while ( size > 0 ) {
+        ssize_t put = write( fd, bytes, size );
+        if ( put < 0 && errno == EINTR )
+            continue;
+        if ( put <= 0 )
+            return false;
+        bytes += put;
+        size -= put;
+    }
+    return true;
+}
+
+/**
+ * Body of a worker process: plays chunks as they are asked for until the
+ * coordinator closes the socket.
+ *
+ * @param fd the worker's end of the socket
+ */
+static void workerLoop( int fd )
+{
+    ChunkRequest request;
+    while ( readFull( fd, &request, sizeof( request ) ) ) {
+        long histogram[ MAX_SIM_GUESSES + 1 ] = { 0 };
+        simulateTargets( request.first, request.last, histogram );
+
+        ChunkResult result = { request.first, request.last, { 0 } };
+        for ( int g = 0; g <= MAX_SIM_GUESSES; g++ )
+            result.histogram[ g ] = histogram[ g ];
+        if ( !writeFull( fd, &result, sizeof( result ) ) )
+            break;
+    }
+    _exit( EXIT_SUCCESS );
+}
+
+/**
+ * Gives up on a worker: its chunk goes back to be handed out again.
+ *
+ * @param worker the worker
+ * @param states the state of every chunk
+ * @param reassigned the count of chunks handed back, updated
+ */
+static void dropWorker( Worker *worker, ChunkState states[], int *reassigned )
+{
+    close( worker->fd );
+    kill( worker->pid, SIGKILL );
+    waitpid( worker->pid, NULL, 0 );
+    worker->alive = false;
+
+    if ( worker->chunk >= 0 ) {
+        states[ worker->chunk ] = CHUNK_PENDING;
+        worker->chunk = -1;
+        ( *reassigned )++;
+    }
+}
+
+/**
+ * Hands an idle worker the first chunk still waiting, if any.
+ *
+ * @param worker the worker
+ * @param states the state of every chunk
+ * @param numChunks the number of chunks
+ * @param numWords the number of targets
+ * @param allowed nanoseconds the worker has to play the chunk
+ * @param reassigned the count of chunks handed back, updated if the worker fails
+ */
+static void assignChunk( Worker *worker, ChunkState states[], int numChunks, int numWords, long allowed, int *reassigned )
+{
+    int chunk = 0;
+    while ( chunk < numChunks && states[ chunk ] != CHUNK_PENDING )
+        chunk++;
+    if ( chunk == numChunks )
+        return;
+
+    ChunkRequest request = { chunk * SIMULATE_CHUNK, ( chunk + 1 ) * SIMULATE_CHUNK < numWords ? ( chunk + 1 ) * SIMULATE_CHUNK : numWords };
+    states[ chunk ] = CHUNK_RUNNING;
+    worker->chunk = chunk;
+    worker->assignedAt = monotonicNanos();
+    worker->deadline = worker->assignedAt + allowed;
+    if ( !writeFull( worker->fd, &request, sizeof( request ) ) )
+        dropWorker( worker, states, reassigned );
+}
+
+void simulateWithWorkers( FILE *out, int numWorkers, char const checkpoint[] )
+{
+    int numWords = lexiconSize();
+    int numChunks = ( numWords + SIMULATE_CHUNK - 1 ) / SIMULATE_CHUNK;
+
+    //chunks a checkpoint says are done are never handed out
+    SimProgress progress;
+    startProgress( &progress, numChunks, checkpoint );
+    ChunkState *states = countedMalloc( ALLOC_SESSION, numChunks * sizeof( ChunkState ) );
+    for ( int c = 0; c < numChunks; c++ )
+        states[ c ] = progress.done[ c ] ? CHUNK_DONE : CHUNK_PENDING;
+
+    //a worker that dies mid-write must not take the coordinator with it
+    signal( SIGPIPE, SIG_IGN );
+
+    //output still buffered would otherwise be printed by every worker too
+    fflush( NULL );
+    Worker workers[ MAX_SIM_WORKERS ];
+    int started = 0;
+    for ( int w = 0; w < numWorkers; w++ ) {
+        int ends[ 2 ];
+        if ( socketpair( AF_UNIX, SOCK_STREAM, 0, ends ) != 0 )
+            break;
+
+        pid_t pid = fork();
+        if ( pid == 0 ) {
+            close( ends[ 0 ] );
+            for ( int other = 0; other < started; other++ )
+                close( workers[ other ].fd );
+            workerLoop( ends[ 1 ] );
+        }
+
+        close( ends[ 1 ] );
+        if ( pid < 0 ) {
+            close( ends[ 0 ] );
+            break;
+        }
+        workers[ started++ ] = (Worker) { pid, ends[ 0 ], -1, 0, 0, true };
+    }
+
+    //a hung worker never closes its socket, so every chunk has a deadline
+    //that grows with the slowest chunk played so far
+    long slowest = 0;
+    long allowed = MIN_CHUNK_SECONDS * NANOS_PER_SECOND;
+    int reassigned = 0;
+    for ( int w = 0; w < started; w++ )
+        assignChunk( &workers[ w ], states, numChunks, numWords, allowed, &reassigned );
+
+    while ( progress.numDone < numChunks ) {
+
+        //wait for any busy worker to report, or for the first deadline
+        struct pollfd polls[ MAX_SIM_WORKERS ];
+        int polled[ MAX_SIM_WORKERS ];
+        int numPolls = 0;
+        long firstDeadline = 0;
+        for ( int w = 0; w < started; w++ ) {
+            if ( workers[ w ].alive && workers[ w ].chunk >= 0 ) {
+                polls[ numPolls ] = (struct pollfd) { workers[ w ].fd, POLLIN, 0 };
+                polled[ numPolls++ ] = w;
+                if ( numPolls == 1 || workers[ w ].deadline < firstDeadline )
+                    firstDeadline = workers[ w ].deadline;
+            }
+        }
+
+        //with no worker left the coordinator plays what remains itself
+        if ( numPolls == 0 ) {
+            for ( int c = 0; c < numChunks; c++ ) {
+                if ( states[ c ] != CHUNK_PENDING )
+                    continue;
+                long histogram[ MAX_SIM_GUESSES + 1 ] = { 0 };
+                simulateTargets( c * SIMULATE_CHUNK, ( c + 1 ) * SIMULATE_CHUNK < numWords ? ( c + 1 ) * SIMULATE_CHUNK : numWords, histogram );
+                states[ c ] = CHUNK_DONE;
+                finishChunk( &progress, c, histogram, checkpoint );
+            }
+            break;
+        }
+
+        long wait = ( firstDeadline - monotonicNanos() ) / NANOS_PER_MILLI + 1;
+        if ( poll( polls, numPolls, wait > 0 ? wait : 0 ) < 0 )
+            continue;
+
+        for ( int p = 0; p < numPolls; p++ ) {
+            Worker *worker = &workers[ polled[ p ] ];
+            if ( polls[ p ].revents == 0 ) {
+                if ( monotonicNanos() >= worker->deadline )
+                    dropWorker( worker, states, &reassigned );
+                continue;
+            }
+
+            //a result must be whole and for the chunk the worker was given
+            ChunkResult result;
+            if ( !readFull( worker->fd, &result, sizeof( result ) ) || result.first != worker->chunk * SIMULATE_CHUNK ) {
+                dropWorker( worker, states, &reassigned );
+                continue;
+            }
+
+            long histogram[ MAX_SIM_GUESSES + 1 ];
+            for ( int g = 0; g <= MAX_SIM_GUESSES; g++ )
+                histogram[ g ] = result.histogram[ g ];
+            states[ worker->chunk ] = CHUNK_DONE;
+            finishChunk( &progress, worker->chunk, histogram, checkpoint );
+            worker->chunk = -1;
+
+            long took = monotonicNanos() - worker->assignedAt;
+            if ( took > slowest ) {
+                slowest = took;
+                if ( slowest * CHUNK_TIME_FACTOR > allowed )
+                    allowed = slowest * CHUNK_TIME_FACTOR;
+            }
+        }
+
+        //idle workers pick up new chunks and any handed back
+        for ( int w = 0; w < started; w++ )
+            if ( workers[ w ].alive && workers[ w ].chunk < 0 )
+                assignChunk( &workers[ w ], states, numChunks, numWords, allowed, &reassigned );
+    }
+
+    //closing the sockets tells the workers to exit
+    int alive = 0;
+    for ( int w = 0; w < started; w++ ) {
+        if ( workers[ w ].alive ) {
+            close( workers[ w ].fd );
+            waitpid( workers[ w ].pid, NULL, 0 );
+            alive++;
+        }
+    }
+
+    if ( checkpoint != NULL )
+        saveCheckpoint( &progress, checkpoint );
+
+    resetCandidates();
+    fprintf( out, "opener %s\n", lexiconWord( suggestGuess() ) );
+    printHistogram( out, progress.histogram );
+    fprintf( out, "%d chunks on %d workers, %d still alive, %d chunks reassigned\n", numChunks, started, alive, reassigned );
+    countedFree( ALLOC_SESSION, states );
+    freeProgress( &progress );
+}
@@ -0,0 +1,31 @@
+/**
+ * @file distsim.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-12
+ *
+ * Runs the simulation of a game against every word across worker
+ * processes. A coordinator splits the targets into chunks and hands them
+ * out one at a time over a local socket to each worker, which plays the
+ * chunk and sends back its histogram. A chunk held by a worker that dies,
+ * or that takes far longer than any chunk has before, goes back to be
+ * handed out again, and the histograms are merged as they come in. The messages are plain fixed-size records, so the workers
+ * could as well be on other machines.
+ *
+ */
+#include <stdio.h>
+
+/** Most worker processes a simulation can be spread across */
+#define MAX_SIM_WORKERS 64
+
+/**
+ * Simulates a game against every word of the list with the given number of
+ * worker processes, and prints how many guesses the games took. The solver
+ * must be prepared; the workers are forked with its index in place.
+ * Chunks are handed out SIMULATE_CHUNK targets at a time, and progress
+ * is checkpointed like simulateGames does, so either can resume the other.
+ *
+ * @param out the file the results are printed to
+ * @param workers the number of worker processes
+ * @param checkpoint the checkpoint file, or NULL for none
+ */
+void simulateWithWorkers( FILE *out, int workers, char const checkpoint[] );
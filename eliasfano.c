@@ -0,0 +1,300 @@
+/**
+ * @file eliasfano.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-02
+ *
+ * A compressed word list. Each word of a sorted list of one length is read
+ * as a base-26 number, which keeps the numbers in the same order as the
+ * words, and the increasing numbers are stored with Elias-Fano encoding in
+ * about 2 + log2( 26 ^ len / n ) bits per word. Membership, rank (word to
+ * index) and select (index to word) all work directly on the compressed
+ * form.
+ *
+ */
+#include "eliasfano.h"
+#include "lexicon.h"
+#include "io.h"
+#include "alloc.h"
+#include "metrics.h"
+
+#include <string.h>
+
+/** Number of letters in the alphabet, the base words are read in */
+#define ALPHABET_SIZE 26
+
+/** Number of bits in a word of the bit arrays */
+#define WORD_BITS 64
+
+/** Number of lookups timed in the benchmark for each operation */
+#define BENCH_LOOKUPS 1000000
+
+/**
+ * Reads a word as a base-26 number, first letter most significant, so
+ * numbers compare the same way as words of the same length.
+ *
+ * @param word the word
+ * @param len the number of letters
+ * @return uint64_t the number
+ */
+static uint64_t wordKey( char const word[], int len )
+{
+    uint64_t key = 0;
+    for ( int i = 0; i < len; i++ )
+        key = key * ALPHABET_SIZE + ( word[ i ] - LOWERCASE_A );
+    return key;
+}
+
+/**
+ * Writes the word a base-26 number stands for.
+ *
+ * @param key the number
+ * @param len the number of letters
+ * @param word where the word is stored, with its null terminator
+ */
+static void keyWord( uint64_t key, int len, char word[] )
+{
+    word[ len ] = NULL_TERMINATOR;
+    for ( int i = len - 1; i >= 0; i-- ) {
+        word[ i ] = LOWERCASE_A + key % ALPHABET_SIZE;
+        key /= ALPHABET_SIZE;
+    }
+}
+
+/**
+ * Reads the low bits of key i, which may straddle two array words.
+ *
+ * @param ef the encoding
+ * @param i the index of the key
+ * @return uint64_t its low bits
+ */
+static uint64_t getLow( EliasFano const *ef, long i )
+{
+    if ( ef->lowBits == 0 )
+        return 0;
+
+    uint64_t pos = (uint64_t) i * ef->lowBits;
+    uint64_t word = pos / WORD_BITS, shift = pos % WORD_BITS;
+    uint64_t value = ef->low[ word ] >> shift;
+    if ( shift + ef->lowBits > WORD_BITS )
+        value |= ef->low[ word + 1 ] << ( WORD_BITS - shift );
+    return value & ( ( 1ULL << ef->lowBits ) - 1 );
+}
+
+/**
+ * Finds the position of the rank-th bit equal to bit in high, starting
+ * from the nearest sample and counting whole array words with popcount.
+ *
+ * @param ef the encoding
+ * @param rank which bit, counting from 0
+ * @param bit whether one bits or zero bits are counted
+ * @return long its position in high
+ */
+static long selectBit( EliasFano const *ef, long rank, bool bit )
+{
+    long const *samples = bit ? ef->oneSamples : ef->zeroSamples;
+    long pos = samples[ rank / EF_SAMPLE ];
+    long left = rank % EF_SAMPLE;
+
+    //the sampled bit is the one to find if nothing is left over
+    long w = pos / WORD_BITS;
+    uint64_t bits = bit ? ef->high[ w ] : ~ef->high[ w ];
+    bits &= ~0ULL << ( pos % WORD_BITS );
+    while ( true ) {
+        long count = __builtin_popcountll( bits );
+        if ( left < count )
+            break;
+        left -= count;
+        w++;
+        bits = bit ? ef->high[ w ] : ~ef->high[ w ];
+    }
+
+    //drop the lowest set bits until the one we want is the lowest
+    for ( ; left > 0; left-- )
+        bits &= bits - 1;
+    return w * WORD_BITS + __builtin_ctzll( bits );
+}
+
+/**
+ * Finds the index of a key, or -1 if it is not encoded. The keys with the
+ * same high bits as key are the run of one bits right after the zero bit
+ * that ends the previous high value.
+ *
+ * @param ef the encoding
+ * @param key the key
+ * @return long its index, or -1
+ */
+static long findKey( EliasFano const *ef, uint64_t key )
+{
+    uint64_t highPart = key >> ef->lowBits;
+    uint64_t lowPart = key & ( ( 1ULL << ef->lowBits ) - 1 );
+
+    long pos = highPart == 0 ? 0 : selectBit( ef, highPart - 1, false ) + 1;
+    long index = pos - highPart;
+    while ( index < ef->n && ( ef->high[ pos / WORD_BITS ] >> ( pos % WORD_BITS ) & 1 ) ) {
+        uint64_t low = getLow( ef, index );
+        if ( low == lowPart )
+            return index;
+        if ( low > lowPart )
+            return -1;
+        pos++;
+        index++;
+    }
+    return -1;
+}
+
+void encodeLexicon( EliasFano *ef )
+{
+    long n = lexiconSize();
+    int len = wordLength();
+    ef->n = n;
+    ef->wordLen = len;
+
+    //keep about log2( universe / n ) low bits, so the high bits average two bits a key
+    uint64_t universe = 1;
+    for ( int i = 0; i < len; i++ )
+        universe *= ALPHABET_SIZE;
+    ef->lowBits = 0;
+    while ( n > 0 && ( universe / n ) >> ( ef->lowBits + 1 ) > 0 )
+        ef->lowBits++;
+
+    long lowWords = ( n * ef->lowBits + WORD_BITS - 1 ) / WORD_BITS + 1;
+    long highBits = n + ( universe >> ef->lowBits ) + 1;
+    ef->highWords = ( highBits + WORD_BITS - 1 ) / WORD_BITS + 1;
+    ef->low = countedMalloc( ALLOC_INDEX, lowWords * sizeof( uint64_t ) );
+    ef->high = countedMalloc( ALLOC_INDEX, ef->highWords * sizeof( uint64_t ) );
+    memset( ef->low, 0, lowWords * sizeof( uint64_t ) );
+    memset( ef->high, 0, ef->highWords * sizeof( uint64_t ) );
+
+    for ( long i = 0; i < n; i++ ) {
+        uint64_t key = wordKey( lexiconWord( i ), len );
+
+        //the low bits go in as is, possibly across two array words
+        uint64_t lowPart = key & ( ( 1ULL << ef->lowBits ) - 1 );
+        uint64_t pos = (uint64_t) i * ef->lowBits;
+        if ( ef->lowBits > 0 ) {
+            ef->low[ pos / WORD_BITS ] |= lowPart << ( pos % WORD_BITS );
+            if ( pos % WORD_BITS + ef->lowBits > WORD_BITS )
+                ef->low[ pos / WORD_BITS + 1 ] |= lowPart >> ( WORD_BITS - pos % WORD_BITS );
+        }
+
+        //the high bits go in as a one bit after as many zero bits as their value
+        uint64_t bit = ( key >> ef->lowBits ) + i;
+        ef->high[ bit / WORD_BITS ] |= 1ULL << ( bit % WORD_BITS );
+    }
+
+    //sample the position of every EF_SAMPLE-th one and zero bit
+    long zeros = highBits - n;
+    ef->numZeroSamples = zeros / EF_SAMPLE + 1;
+    ef->oneSamples = countedMalloc( ALLOC_INDEX, ( n / EF_SAMPLE + 1 ) * sizeof( long ) );
+    ef->zeroSamples = countedMalloc( ALLOC_INDEX, ef->numZeroSamples * sizeof( long ) );
+    long ones = 0, zeroCount = 0;
+    for ( long pos = 0; pos < highBits; pos++ ) {
+        if ( ef->high[ pos / WORD_BITS ] >> ( pos % WORD_BITS ) & 1 ) {
+            if ( ones % EF_SAMPLE == 0 )
+                ef->oneSamples[ ones / EF_SAMPLE ] = pos;
+            ones++;
+        } else {
+            if ( zeroCount % EF_SAMPLE == 0 )
+                ef->zeroSamples[ zeroCount / EF_SAMPLE ] = pos;
+            zeroCount++;
+        }
+    }
+}
+
+void freeEliasFano( EliasFano *ef )
+{
+    countedFree( ALLOC_INDEX, ef->low );
+    countedFree( ALLOC_INDEX, ef->high );
+    countedFree( ALLOC_INDEX, ef->oneSamples );
+    countedFree( ALLOC_INDEX, ef->zeroSamples );
+}
+
+long efRank( EliasFano const *ef, char const word[] )
+{
+    return findKey( ef, wordKey( word, ef->wordLen ) );
+}
+
+void efSelect( EliasFano const *ef, long index, char word[] )
+{
+    //the ith one bit sits i places past the high value of key i
+    uint64_t highPart = selectBit( ef, index, true ) - index;
+    keyWord( highPart << ef->lowBits | getLow( ef, index ), ef->wordLen, word );
+}
+
+bool efContains( EliasFano const *ef, char const word[] )
+{
+    return efRank( ef, word ) >= 0;
+}
+
+long efBytes( EliasFano const *ef )
+{
+    long lowWords = ( ef->n * ef->lowBits + WORD_BITS - 1 ) / WORD_BITS + 1;
+    return sizeof( EliasFano ) + ( lowWords + ef->highWords ) * sizeof( uint64_t ) +
+           ( ef->n / EF_SAMPLE + 1 + ef->numZeroSamples ) * sizeof( long );
+}
+
+void benchmarkEliasFano( FILE *out )
+{
+    EliasFano ef;
+    long n = lexiconSize();
+    int len = wordLength();
+    if ( n == 0 ) {
+        fprintf( out, "The word list has no words\n" );
+        return;
+    }
+    encodeLexicon( &ef );
+
+    //half the probes are words of the list, half are random strings that mostly are not
+    char ( *probes )[ MAX_WORD_LEN + 1 ] = countedMalloc( ALLOC_SESSION, BENCH_LOOKUPS * sizeof( *probes ) );
+    unsigned long state = 1;
+    for ( long i = 0; i < BENCH_LOOKUPS; i++ ) {
+        state = state * 6364136223846793005UL + 1442695040888963407UL;
+        if ( i % 2 == 0 )
+            strcpy( probes[ i ], lexiconWord( ( state >> 33 ) % n ) );
+        else
+            for ( int c = 0; c <= len; c++ )
+                probes[ i ][ c ] = c == len ? NULL_TERMINATOR : LOWERCASE_A + ( state >> ( 20 + 5 * c ) ) % ALPHABET_SIZE;
+    }
+
+    //make sure both forms agree before timing them
+    char word[ MAX_WORD_LEN + 1 ];
+    for ( long i = 0; i < n; i++ ) {
+        efSelect( &ef, i, word );
+        if ( strcmp( word, lexiconWord( i ) ) != 0 || efRank( &ef, word ) != i ) {
+            fprintf( out, "Elias-Fano encoding does not match the word list at %ld\n", i );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    //the list is searched directly, inList would time and record every look up
+    Session const *session = currentSession();
+    long start = monotonicNanos();
+    long listHits = 0;
+    for ( long i = 0; i < BENCH_LOOKUPS; i++ )
+        listHits += sessionContains( session, probes[ i ] );
+    long listNanos = monotonicNanos() - start;
+
+    start = monotonicNanos();
+    long efHits = 0;
+    for ( long i = 0; i < BENCH_LOOKUPS; i++ )
+        efHits += efContains( &ef, probes[ i ] );
+    long efNanos = monotonicNanos() - start;
+
+    start = monotonicNanos();
+    for ( long i = 0; i < BENCH_LOOKUPS; i++ )
+        efSelect( &ef, ( i * 7919 ) % n, word );
+    long selectNanos = monotonicNanos() - start;
+
+    //the list is a pointer per word plus the word and its terminator
+    long listBytes = n * ( sizeof( char * ) + len + 1 );
+    fprintf( out, "%ld words of %d letters, %d low bits\n", n, len, ef.lowBits );
+    fprintf( out, "%-14s %12s %14s %16s\n", "form", "bytes", "bits per word", "ns per lookup" );
+    fprintf( out, "%-14s %12ld %14.2f %16.1f\n", "char **", listBytes, 8.0 * listBytes / n, (double) listNanos / BENCH_LOOKUPS );
+    fprintf( out, "%-14s %12ld %14.2f %16.1f\n", "elias-fano", efBytes( &ef ), 8.0 * efBytes( &ef ) / n, (double) efNanos / BENCH_LOOKUPS );
+    fprintf( out, "elias-fano select: %.1f ns per index\n", (double) selectNanos / BENCH_LOOKUPS );
+    if ( listHits != efHits )
+        fprintf( out, "Membership differs: %ld list hits, %ld elias-fano hits\n", listHits, efHits );
+
+    countedFree( ALLOC_SESSION, probes );
+    freeEliasFano( &ef );
+}
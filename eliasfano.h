@@ -0,0 +1,99 @@
+/**
+ * @file eliasfano.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-02
+ *
+ * A compressed word list. Each word of a sorted list of one length is read
+ * as a base-26 number, which keeps the numbers in the same order as the
+ * words, and the increasing numbers are stored with Elias-Fano encoding in
+ * about 2 + log2( 26 ^ len / n ) bits per word. Membership, rank (word to
+ * index) and select (index to word) all work directly on the compressed
+ * form.
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** A sorted list of words in Elias-Fano encoding */
+typedef struct {
+    /** Number of words and their length */
+    long n;
+    int wordLen;
+
+    /** Number of low bits of each key stored as is */
+    int lowBits;
+
+    /** The low bits of every key, lowBits each, packed back to back */
+    uint64_t *low;
+
+    /** The high bits of every key in unary: key i sets bit ( key >> lowBits ) + i */
+    uint64_t *high;
+    long highWords;
+
+    /** Position in high of every EF_SAMPLE-th one bit and zero bit */
+    long *oneSamples;
+    long *zeroSamples;
+    long numZeroSamples;
+} EliasFano;
+
+/** Every this many one bits or zero bits get a sample, trading memory for select speed */
+#define EF_SAMPLE 256
+
+/**
+ * Encodes the sorted list of words chosen in the lexicon.
+ *
+ * @param ef where the encoding is stored
+ */
+void encodeLexicon( EliasFano *ef );
+
+/**
+ * Frees the memory of an encoding.
+ *
+ * @param ef the encoding
+ */
+void freeEliasFano( EliasFano *ef );
+
+/**
+ * Finds the index of a word in the encoded list.
+ *
+ * @param ef the encoding
+ * @param word the word, ef->wordLen lowercase letters
+ * @return long its index, or -1 if it is not in the list
+ */
+long efRank( EliasFano const *ef, char const word[] );
+
+/**
+ * Decodes the word at an index of the encoded list.
+ *
+ * @param ef the encoding
+ * @param index the index, between 0 and ef->n - 1
+ * @param word where the word is stored, with room for ef->wordLen letters
+ */
+void efSelect( EliasFano const *ef, long index, char word[] );
+
+/**
+ * Checks if a word is in the encoded list.
+ *
+ * @param ef the encoding
+ * @param word the word, ef->wordLen lowercase letters
+ * @return true if the word is in the list
+ * @return false if else
+ */
+bool efContains( EliasFano const *ef, char const word[] );
+
+/**
+ * Returns the number of bytes the encoding takes up.
+ *
+ * @param ef the encoding
+ * @return long its size in bytes
+ */
+long efBytes( EliasFano const *ef );
+
+/**
+ * Compares the encoding of the chosen list with the list itself: memory
+ * used, and the time of membership checks, rank and select.
+ *
+ * @param out the file the results are printed to
+ */
+void benchmarkEliasFano( FILE *out );
@@ -0,0 +1,258 @@
+/**
+ * @file extsort.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-18
+ *
+ * Sorts word lists that are too large to hold in memory. The list is read
+ * in runs that fit under a memory cap, each run is sorted and spilled to a
+ * temporary file, and the runs are merged k at a time into a sorted list
+ * in the same format as the input. Runs are merged as soon as k of them
+ * are waiting, so only a few files are open however long the list is.
+ *
+ */
+#include "extsort.h"
+#include "lexicon.h"
+#include "io.h"
+#include "alloc.h"
+#include "normalize.h"
+
+#include <string.h>
+
+/** Most runs merged at once, which keeps the number of open files bounded */
+#define MAX_FAN_IN 64
+
+/** Most levels of merged runs, enough for MAX_FAN_IN ^ MAX_LEVELS runs */
+#define MAX_LEVELS 8
+
+/**
+ * The spilled runs waiting to be merged, each a temporary file of WORD_LEN
+ * byte records. A run on level l is the merge of MAX_FAN_IN runs of level
+ * l - 1, and a level is merged into one run of the next as soon as it is full.
+ */
+typedef struct {
+    FILE *files[ MAX_LEVELS ][ MAX_FAN_IN ];
+    int counts[ MAX_LEVELS ];
+} RunLevels;
+
+/** One run being merged: its file and the word at its front */
+typedef struct {
+    FILE *file;
+    char word[ WORD_LEN ];
+} Cursor;
+
+/**
+ * Compares two WORD_LEN byte records, for qsort.
+ *
+ * @param a the first record
+ * @param b the second record
+ * @return int negative, zero or positive like strcmp
+ */
+static int compareRecords( void const *a, void const *b )
+{
+    return memcmp( a, b, WORD_LEN );
+}
+
+/**
+ * Exits with an error, removing the sorted list if it was partly written.
+ *
+ * @param message the error
+ * @param out the file being written when the error happened
+ * @param output the name of out if it is the sorted list, NULL if it is a run
+ */
+static void sortError( char const message[], FILE *out, char const output[] )
+{
+    fprintf( stderr, "%s\n", message );
+    if ( output != NULL ) {
+        fclose( out );
+        remove( output );
+    }
+    exit( EXIT_FAILURE );
+}
+
+/**
+ * Opens a new temporary file, exiting with an error if it cannot.
+ *
+ * @return FILE* the temporary file, removed automatically when closed
+ */
+static FILE *openTemp()
+{
+    FILE *fp = tmpfile();
+    if ( fp == NULL ) {
+        fprintf( stderr, "Can't create a temporary file\n" );
+        exit( EXIT_FAILURE );
+    }
+    return fp;
+}
+
+/**
+ * Moves a cursor down the heap until both of its children hold larger words.
+ *
+ * @param heap the heap of cursors, smallest word first
+ * @param size the number of cursors in the heap
+ * @param i the index of the cursor being moved
+ */
+static void siftDown( Cursor heap[], int size, int i )
+{
+    while ( true ) {
+        int smallest = i;
+        int left = 2 * i + 1, right = 2 * i + 2;
+        if ( left < size && memcmp( heap[ left ].word, heap[ smallest ].word, WORD_LEN ) < 0 )
+            smallest = left;
+        if ( right < size && memcmp( heap[ right ].word, heap[ smallest ].word, WORD_LEN ) < 0 )
+            smallest = right;
+        if ( smallest == i )
+            return;
+
+        Cursor temp = heap[ i ];
+        heap[ i ] = heap[ smallest ];
+        heap[ smallest ] = temp;
+        i = smallest;
+    }
+}
+
+/**
+ * Merges count runs into out and closes them. Uses a min-heap of the word
+ * at the front of each run, so each word costs O(log count) comparisons.
+ * Runs are sorted and the heap hands out words in order, so a duplicate
+ * always comes right after its twin.
+ *
+ * Exits with the invalid word file error, the same way loading a list
+ * does, if a word is there twice.
+ *
+ * @param files the runs being merged
+ * @param count the number of runs
+ * @param out where the merged words are written
+ * @param output the name of out if it is the sorted list, written one word
+ *               per line like a word list, or NULL if it is a run for
+ *               another merge pass, written as WORD_LEN byte records
+ */
+static void mergeRuns( FILE *files[], int count, FILE *out, char const output[] )
+{
+    Cursor heap[ MAX_FAN_IN ];
+    int size = 0;
+    for ( int i = 0; i < count; i++ ) {
+        rewind( files[ i ] );
+        if ( fread( heap[ size ].word, WORD_LEN, 1, files[ i ] ) == 1 )
+            heap[ size++ ].file = files[ i ];
+    }
+    for ( int i = size / 2 - 1; i >= 0; i-- )
+        siftDown( heap, size, i );
+
+    char previous[ WORD_LEN ];
+    bool first = true;
+    while ( size > 0 ) {
+
+        //the smallest word is at the root of the heap
+        if ( !first && memcmp( previous, heap[ 0 ].word, WORD_LEN ) == 0 )
+            sortError( "Invalid word file", out, output );
+        memcpy( previous, heap[ 0 ].word, WORD_LEN );
+        first = false;
+
+        if ( fwrite( heap[ 0 ].word, WORD_LEN, 1, out ) != 1 || ( output != NULL && putc( '\n', out ) == EOF ) )
+            sortError( output != NULL ? "Can't write the output file" : "Can't write a temporary file", out, output );
+
+        //refill the root from the same run, or drop the run once it is empty
+        if ( fread( heap[ 0 ].word, WORD_LEN, 1, heap[ 0 ].file ) != 1 )
+            heap[ 0 ] = heap[ --size ];
+        siftDown( heap, size, 0 );
+    }
+
+    for ( int i = 0; i < count; i++ )
+        fclose( files[ i ] );
+}
+
+/**
+ * Adds a run to a level, merging the level into one run of the next level
+ * if that fills it.
+ *
+ * @param levels the runs waiting to be merged
+ * @param level the level of the run
+ * @param file the temporary file holding the run
+ */
+static void addRun( RunLevels *levels, int level, FILE *file )
+{
+    if ( level == MAX_LEVELS ) {
+        fprintf( stderr, "The word list has too many runs to merge\n" );
+        exit( EXIT_FAILURE );
+    }
+
+    levels->files[ level ][ levels->counts[ level ]++ ] = file;
+    if ( levels->counts[ level ] == MAX_FAN_IN ) {
+        FILE *spill = openTemp();
+        mergeRuns( levels->files[ level ], MAX_FAN_IN, spill, NULL );
+        levels->counts[ level ] = 0;
+        addRun( levels, level + 1, spill );
+    }
+}
+
+void externalSort( char const input[], char const output[], long memoryCap, bool lenient )
+{
+    //a lenient list is cleaned into a temporary copy first, a chunk at a
+    //time so the whole list is never held in memory
+    FILE *fp;
+    if ( ( fp = lenient ? openNormalizedCopy( input ) : fopen( input, "r" ) ) == NULL ) {
+        fprintf( stderr, "Can't open the word list: %s\n", input );
+        exit( EXIT_FAILURE );
+    }
+
+    //a run holds as many words as fit under the cap, but always at least two
+    long runWords = memoryCap / WORD_LEN;
+    if ( runWords < 2 )
+        runWords = 2;
+    char *run = countedMalloc( ALLOC_LEXICON, runWords * WORD_LEN + 1 );
+
+    RunLevels levels;
+    for ( int l = 0; l < MAX_LEVELS; l++ )
+        levels.counts[ l ] = 0;
+
+    //read, sort and spill runs until the input runs out. readLine writes a
+    //null terminator after each word, which the next word overwrites and the
+    //spare byte at the end of the buffer absorbs
+    bool getAnotherLine = true;
+    while ( getAnotherLine ) {
+        long words = 0;
+        while ( getAnotherLine && words < runWords )
+            getAnotherLine = readLine( fp, run + words++ * WORD_LEN, WORD_LEN );
+
+        qsort( run, words, WORD_LEN, compareRecords );
+
+        FILE *spill = openTemp();
+        if ( fwrite( run, WORD_LEN, words, spill ) != words ) {
+            fprintf( stderr, "Can't write a temporary file\n" );
+            exit( EXIT_FAILURE );
+        }
+        addRun( &levels, 0, spill );
+    }
+    fclose( fp );
+    countedFree( ALLOC_LEXICON, run );
+
+    //carry what is left of each level up into the one above, so the top
+    //level holds every word and one pass can finish the job
+    int top = MAX_LEVELS - 1;
+    while ( top > 0 && levels.counts[ top ] == 0 )
+        top--;
+    for ( int l = 0; l < top; l++ ) {
+        if ( levels.counts[ l ] == 0 )
+            continue;
+        FILE *spill = openTemp();
+        mergeRuns( levels.files[ l ], levels.counts[ l ], spill, NULL );
+        levels.counts[ l ] = 0;
+        addRun( &levels, l + 1, spill );
+    }
+
+    //a carry can fill the top level, which then moves up one itself
+    while ( top + 1 < MAX_LEVELS && levels.counts[ top + 1 ] > 0 )
+        top++;
+
+    FILE *out;
+    if ( ( out = fopen( output, "w" ) ) == NULL ) {
+        fprintf( stderr, "Can't open the output file: %s\n", output );
+        exit( EXIT_FAILURE );
+    }
+    mergeRuns( levels.files[ top ], levels.counts[ top ], out, output );
+    if ( fclose( out ) != 0 ) {
+        fprintf( stderr, "Can't write the output file\n" );
+        remove( output );
+        exit( EXIT_FAILURE );
+    }
+}
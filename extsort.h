@@ -0,0 +1,31 @@
+/**
+ * @file extsort.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-18
+ *
+ * Sorts word lists that are too large to hold in memory. The list is read
+ * in runs that fit under a memory cap, each run is sorted and spilled to a
+ * temporary file, and the runs are merged k at a time into a sorted list
+ * in the same format as the input. Runs are merged as soon as k of them
+ * are waiting, so only a few files are open however long the list is.
+ *
+ */
+#include <stdbool.h>
+
+/** Memory cap used when none is given, in bytes */
+#define DEFAULT_SORT_MEMORY ( 64L * 1024 * 1024 )
+
+/**
+ * Sorts the word list in the file named input into the file named output,
+ * holding at most about memoryCap bytes of words in memory at a time.
+ * Exits with an error if the input is not a valid word file or contains
+ * the same word more than once, the same as loading it does, and leaves no
+ * output behind.
+ *
+ * @param input the name of the word list being sorted
+ * @param output the name of the file the sorted list is written to
+ * @param memoryCap the most bytes of words held in memory at once
+ * @param lenient whether the list is cleaned up like setLenient does before
+ *                it is checked
+ */
+void externalSort( char const input[], char const output[], long memoryCap, bool lenient );
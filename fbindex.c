@@ -0,0 +1,159 @@
+/**
+ * @file fbindex.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-08
+ *
+ * An index of the feedback every guess gets against every answer. For each
+ * guess and feedback code it holds the posting list of answers that give
+ * that feedback, in compressed sparse row form: one offset per guess and
+ * code, and every answer of every guess back to back. Narrowing a set of
+ * candidates after a guess is then one intersection with a posting list.
+ * The feedback codes themselves are kept too, one per guess and answer,
+ * so the size of every feedback group is a table lookup.
+ *
+ */
+#include "fbindex.h"
+#include "lexicon.h"
+#include "feedback.h"
+#include "alloc.h"
+#include "pool.h"
+
+#include <string.h>
+
+/** Guesses indexed per task of the parallel build */
+#define BUILD_GRAIN 8
+
+/** A posting list this many times shorter than the candidates is searched instead of merged */
+#define GALLOP_RATIO 8
+
+/** Number of words, which are both the guesses and the answers */
+static int numWords;
+
+/** Number of feedback codes words of the indexed length can get */
+static int numCodes;
+
+/** The answers of guess g and code c are answers[ offsets[ g * numCodes + c ] ] up to the next offset */
+static int64_t *offsets;
+static int *answers;
+
+/** The feedback guess g gets against answer a is codes[ g * numWords + a ] */
+static uint16_t *codes;
+
+/**
+ * Body of the parallel build, indexing one range of guesses. Every guess
+ * has exactly numWords answers, so each guess fills its own part of the
+ * arrays and no two ranges touch the same memory.
+ *
+ * @param ctx unused
+ * @param start the first guess
+ * @param end one past the last guess
+ */
+static void indexRange( void *ctx, long start, long end )
+{
+    int len = wordLength();
+    int counts[ numCodes ];
+
+    for ( long guess = start; guess < end; guess++ ) {
+        char const *word = lexiconWord( guess );
+        uint16_t *row = codes + guess * numWords;
+
+        //count the answers of every code
+        memset( counts, 0, sizeof( counts ) );
+        for ( int answer = 0; answer < numWords; answer++ ) {
+            row[ answer ] = feedbackCodeOfLength( word, lexiconWord( answer ), len );
+            counts[ row[ answer ] ]++;
+        }
+
+        //turn the counts into offsets, then place the answers in order
+        int64_t *first = offsets + guess * numCodes;
+        int64_t next = guess * numWords;
+        for ( int code = 0; code < numCodes; code++ ) {
+            first[ code ] = next;
+            next += counts[ code ];
+            counts[ code ] = first[ code ];
+        }
+        for ( int answer = 0; answer < numWords; answer++ )
+            answers[ counts[ row[ answer ] ]++ ] = answer;
+    }
+}
+
+bool buildFeedbackIndex()
+{
+    numWords = lexiconSize();
+    numCodes = 1;
+    for ( int i = 0; i < wordLength(); i++ )
+        numCodes *= 3;
+
+    if ( numWords == 0 || (long) numWords * numWords > MAX_INDEX_ENTRIES || (long) numWords * numCodes > MAX_INDEX_ENTRIES )
+        return false;
+
+    offsets = countedMalloc( ALLOC_INDEX, ( (long) numWords * numCodes + 1 ) * sizeof( int64_t ) );
+    answers = countedMalloc( ALLOC_INDEX, (long) numWords * numWords * sizeof( int ) );
+    codes = countedMalloc( ALLOC_INDEX, (long) numWords * numWords * sizeof( uint16_t ) );
+    offsets[ (long) numWords * numCodes ] = (long) numWords * numWords;
+
+    parallelFor( numWords, BUILD_GRAIN, indexRange, NULL );
+    return true;
+}
+
+void freeFeedbackIndex()
+{
+    countedFree( ALLOC_INDEX, offsets );
+    countedFree( ALLOC_INDEX, answers );
+    countedFree( ALLOC_INDEX, codes );
+}
+
+int feedbackCodes()
+{
+    return numCodes;
+}
+
+int postingList( int guess, int code, int const **list )
+{
+    int64_t const *first = offsets + (long) guess * numCodes + code;
+    *list = answers + first[ 0 ];
+    return first[ 1 ] - first[ 0 ];
+}
+
+int indexedFeedback( int guess, int answer )
+{
+    return codes[ (long) guess * numWords + answer ];
+}
+
+int narrowCandidates( int const candidates[], int count, int guess, int code, int narrowed[] )
+{
+    int const *list;
+    int size = postingList( guess, code, &list );
+    int kept = 0;
+
+    //both lists are in increasing order, and nothing is written past what
+    //has been read, so narrowed may be candidates
+    if ( (long) size * GALLOP_RATIO < count ) {
+        //look each answer up in what is left of the candidates
+        int low = 0;
+        for ( int i = 0; i < size && low < count; i++ ) {
+            int high = count;
+            while ( low < high ) {
+                int mid = low + ( high - low ) / 2;
+                if ( candidates[ mid ] < list[ i ] )
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+            if ( low < count && candidates[ low ] == list[ i ] )
+                narrowed[ kept++ ] = candidates[ low++ ];
+        }
+    } else {
+        for ( int i = 0, j = 0; i < count && j < size; ) {
+            if ( candidates[ i ] < list[ j ] )
+                i++;
+            else if ( candidates[ i ] > list[ j ] )
+                j++;
+            else {
+                narrowed[ kept++ ] = candidates[ i++ ];
+                j++;
+            }
+        }
+    }
+    return kept;
+}
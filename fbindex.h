@@ -0,0 +1,74 @@
+/**
+ * @file fbindex.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-08
+ *
+ * An index of the feedback every guess gets against every answer. For each
+ * guess and feedback code it holds the posting list of answers that give
+ * that feedback, in compressed sparse row form: one offset per guess and
+ * code, and every answer of every guess back to back. Narrowing a set of
+ * candidates after a guess is then one intersection with a posting list.
+ * The feedback codes themselves are kept too, one per guess and answer,
+ * so the size of every feedback group is a table lookup.
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Most guess and answer pairs the index is built for, which bounds its memory */
+#define MAX_INDEX_ENTRIES ( 1L << 27 )
+
+/**
+ * Builds the index over the sorted list of words chosen in the lexicon,
+ * every word being both a guess and an answer, spread across the pool.
+ *
+ * @return true if the index was built
+ * @return false if the list has no words, or too many for MAX_INDEX_ENTRIES
+ */
+bool buildFeedbackIndex();
+
+/**
+ * Frees the index.
+ */
+void freeFeedbackIndex();
+
+/**
+ * Returns the number of feedback codes words of the indexed length can get.
+ *
+ * @return int the number of codes
+ */
+int feedbackCodes();
+
+/**
+ * Returns the posting list of a guess and feedback code: the answers,
+ * in increasing order, that give that feedback to that guess.
+ *
+ * @param guess the index of the guess
+ * @param code the feedback code
+ * @param answers where the start of the posting list is stored
+ * @return int the number of answers in it
+ */
+int postingList( int guess, int code, int const **answers );
+
+/**
+ * Returns the feedback a guess gets against an answer.
+ *
+ * @param guess the index of the guess
+ * @param answer the index of the answer
+ * @return int the feedback code
+ */
+int indexedFeedback( int guess, int answer );
+
+/**
+ * Narrows a set of candidates to those that give a guess the feedback it
+ * got, intersecting the set with the guess's posting list.
+ *
+ * @param candidates the candidate answers, in increasing order
+ * @param count the number of candidates
+ * @param guess the index of the guess
+ * @param code the feedback the guess got
+ * @param narrowed where the remaining candidates are stored, in increasing
+ *                 order, with room for count answers; may be candidates
+ * @return int the number of remaining candidates
+ */
+int narrowCandidates( int const candidates[], int count, int guess, int code, int narrowed[] );
@@ -0,0 +1,91 @@
+/**
+ * @file feedback.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-14
+ *
+ * Computes the feedback a guess gets against a target word as a single
+ * number, and prints a guess in the colors that feedback stands for.
+ * Each letter of a guess gets one base-3 digit of the code, with the
+ * first letter as the least significant digit.
+ *
+ */
+#include "feedback.h"
+#include "lexicon.h"
+#include "io.h"
+#include "metrics.h"
+#include "trace.h"
+
+/** Number of letters in the alphabet */
+#define ALPHABET_SIZE 26
+
+/** Value of one in each letter's digit, the first letter being least significant */
+static const int placeValues[ MAX_WORD_LEN ] = { 1, 3, 9, 27, 81, 243, 729, 2187 };
+
+int feedbackCode( char const guess[], char const target[] )
+{
+    //a constant length lets the compiler unroll the loops for the hot path
+    return feedbackCodeOfLength( guess, target, WORD_LEN );
+}
+
+int feedbackCodeOfLength( char const guess[], char const target[], int len )
+{
+    //every analysis computes millions of codes, so they are only timed for a tracer
+    long start = TRACE_ENABLED( feedback ) ? monotonicNanos() : 0;
+
+    //count the target letters that are not matched by a green letter,
+    //these are the ones a yellow letter can still be tied to
+    unsigned char unmatched[ ALPHABET_SIZE ] = { 0 };
+    int code = 0;
+    for ( int i = 0; i < len; i++ ) {
+        if ( guess[ i ] == target[ i ] )
+            code += FEEDBACK_GREEN * placeValues[ i ];
+        else
+            unmatched[ target[ i ] - LOWERCASE_A ]++;
+    }
+
+    //decide yellow letters from left to right like the game does
+    for ( int i = 0; i < len; i++ ) {
+        if ( guess[ i ] != target[ i ] && unmatched[ guess[ i ] - LOWERCASE_A ] > 0 ) {
+            unmatched[ guess[ i ] - LOWERCASE_A ]--;
+            code += FEEDBACK_YELLOW * placeValues[ i ];
+        }
+    }
+
+    if ( TRACE_ENABLED( feedback ) )
+        TRACE5( feedback, guess, target, len, code, monotonicNanos() - start );
+    return code;
+}
+
+void printFeedback( char const guess[], int code )
+{
+    //keeps track of the current color being printed
+    //effectively works as a state machine
+    int currentColor = FEEDBACK_GRAY;
+
+    for ( int i = 0; guess[ i ]; i++ ) {
+
+        //peel off this letter's digit
+        int digit = code % FEEDBACK_BASE;
+        code /= FEEDBACK_BASE;
+
+        //only switch colors when the color changes
+        if ( digit != currentColor ) {
+            if ( digit == FEEDBACK_GREEN )
+                colorGreen();
+            else if ( digit == FEEDBACK_YELLOW )
+                colorYellow();
+            else
+                colorDefault();
+            currentColor = digit;
+        }
+
+        putc( guess[ i ], stdout );
+    }
+
+    //make sure to return to default color if last character printed was yellow or green
+    if ( currentColor != FEEDBACK_GRAY )
+        colorDefault();
+
+    //print a line-feed
+    putc( '\n', stdout );
+}
@@ -0,0 +1,63 @@
+/**
+ * @file feedback.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-14
+ *
+ * Computes the feedback a guess gets against a target word as a single
+ * number, and prints a guess in the colors that feedback stands for.
+ * Each letter of a guess gets one base-3 digit of the code, with the
+ * first letter as the least significant digit.
+ *
+ */
+
+/** Number of different feedback codes a guess can get, 3 ^ WORD_LEN */
+#define NUM_FEEDBACK_CODES 243
+
+/** Number of values a single feedback digit can take */
+#define FEEDBACK_BASE 3
+
+/** Digit of a letter that is not in the target word */
+#define FEEDBACK_GRAY 0
+
+/** Digit of a letter that is in the target word but in a different position */
+#define FEEDBACK_YELLOW 1
+
+/** Digit of a letter that is in the correct position */
+#define FEEDBACK_GREEN 2
+
+/** Code of a guess that is identical to the target, every digit green */
+#define FEEDBACK_SOLVED ( NUM_FEEDBACK_CODES - 1 )
+
+/**
+ * Computes the feedback code of guess against target. Letters in the
+ * correct position are green. The remaining letters are yellow, from left
+ * to right, as long as the target still has an unmatched copy of the letter.
+ *
+ * @param guess the word that was guessed
+ * @param target the target word
+ *        precondition: both words are WORD_LEN lowercase letters
+ * @return int the feedback code, between 0 and NUM_FEEDBACK_CODES - 1
+ */
+int feedbackCode( char const guess[], char const target[] );
+
+/**
+ * Computes the feedback code of guess against target like feedbackCode,
+ * for words of any length up to MAX_WORD_LEN. Codes of words longer than
+ * WORD_LEN can be NUM_FEEDBACK_CODES or more.
+ *
+ * @param guess the word that was guessed
+ * @param target the target word
+ * @param len the number of letters in both words
+ * @return int the feedback code, between 0 and 3 ^ len - 1
+ */
+int feedbackCodeOfLength( char const guess[], char const target[], int len );
+
+/**
+ * Prints guess to stdout with every letter in the color given by its
+ * digit of code, followed by a line-feed. The color is only changed
+ * when it differs from the previous letter's color.
+ *
+ * @param guess the word that was guessed
+ * @param code the feedback code of the guess
+ */
+void printFeedback( char const guess[], int code );
@@ -0,0 +1,252 @@
+/**
+ * @file fingerprint.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-20
+ *
+ * A fast 64-bit hash of a stream of bytes, used to tie everything built
+ * from a word list to the exact words it was built from. Bytes are taken
+ * 32 at a time into four independent lanes, so the work of one block never
+ * waits on the block before it, and any bytes short of a block wait in a
+ * buffer for the next ones. It follows the xxHash64 construction, so
+ * adding bytes in any number of pieces gives the hash of them all at once.
+ *
+ */
+#include "fingerprint.h"
+#include "lexicon.h"
+#include "metrics.h"
+#include "alloc.h"
+
+#include <string.h>
+
+/** The primes of xxHash64 */
+#define PRIME_1 0x9e3779b185ebca87UL
+#define PRIME_2 0xc2b2ae3d27d4eb4fUL
+#define PRIME_3 0x165667b19e3779f9UL
+#define PRIME_4 0x85ebca77c2b2ae63UL
+#define PRIME_5 0x27d4eb2f165667c5UL
+
+/** Starting value of the FNV-1a hash the benchmark compares with */
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325UL
+
+/** Multiplier of the FNV-1a hash */
+#define FNV_PRIME 0x100000001b3UL
+
+/** Number of bytes the benchmark runs each method over, in passes over the list */
+#define BENCH_BYTES ( 1L << 28 )
+
+/**
+ * Rotates the bits of x left.
+ *
+ * @param x the value
+ * @param bits how far, 1 to 63
+ * @return uint64_t the rotated value
+ */
+static uint64_t rotateLeft( uint64_t x, int bits )
+{
+    return ( x << bits ) | ( x >> ( 64 - bits ) );
+}
+
+/**
+ * Reads 8 bytes, in whatever alignment they are.
+ *
+ * @param bytes the bytes
+ * @return uint64_t their value
+ */
+static uint64_t read64( unsigned char const *bytes )
+{
+    uint64_t value;
+    memcpy( &value, bytes, sizeof( value ) );
+    return value;
+}
+
+/**
+ * Reads 4 bytes, in whatever alignment they are.
+ *
+ * @param bytes the bytes
+ * @return uint64_t their value
+ */
+static uint64_t read32( unsigned char const *bytes )
+{
+    uint32_t value;
+    memcpy( &value, bytes, sizeof( value ) );
+    return value;
+}
+
+/**
+ * Mixes 8 bytes into a lane.
+ *
+ * @param lane the lane
+ * @param input the bytes
+ * @return uint64_t the new lane
+ */
+static uint64_t mixLane( uint64_t lane, uint64_t input )
+{
+    lane += input * PRIME_2;
+    lane = rotateLeft( lane, 31 );
+    return lane * PRIME_1;
+}
+
+/**
+ * Mixes a lane into the final hash.
+ *
+ * @param hash the hash so far
+ * @param lane the lane
+ * @return uint64_t the new hash
+ */
+static uint64_t mergeLane( uint64_t hash, uint64_t lane )
+{
+    hash ^= mixLane( 0, lane );
+    return hash * PRIME_1 + PRIME_4;
+}
+
+/**
+ * Mixes one stripe into the four lanes.
+ *
+ * @param lanes the lanes
+ * @param stripe FINGERPRINT_STRIPE bytes
+ */
+static void addStripe( uint64_t lanes[], unsigned char const *stripe )
+{
+    lanes[ 0 ] = mixLane( lanes[ 0 ], read64( stripe ) );
+    lanes[ 1 ] = mixLane( lanes[ 1 ], read64( stripe + 8 ) );
+    lanes[ 2 ] = mixLane( lanes[ 2 ], read64( stripe + 16 ) );
+    lanes[ 3 ] = mixLane( lanes[ 3 ], read64( stripe + 24 ) );
+}
+
+void startFingerprint( Fingerprint *fp )
+{
+    fp->lanes[ 0 ] = PRIME_1 + PRIME_2;
+    fp->lanes[ 1 ] = PRIME_2;
+    fp->lanes[ 2 ] = 0;
+    fp->lanes[ 3 ] = -PRIME_1;
+    fp->buffered = 0;
+    fp->length = 0;
+}
+
+void addToFingerprint( Fingerprint *fp, void const *bytes, long len )
+{
+    unsigned char const *next = bytes;
+    fp->length += len;
+
+    //bytes short of a stripe wait in the buffer for the next ones
+    if ( fp->buffered + len < FINGERPRINT_STRIPE ) {
+        memcpy( fp->buffer + fp->buffered, next, len );
+        fp->buffered += len;
+        return;
+    }
+
+    //finish the stripe in the buffer, then take whole stripes straight
+    //from the bytes, and keep what is left over for next time
+    if ( fp->buffered > 0 ) {
+        int fill = FINGERPRINT_STRIPE - fp->buffered;
+        memcpy( fp->buffer + fp->buffered, next, fill );
+        addStripe( fp->lanes, fp->buffer );
+        next += fill;
+        len -= fill;
+    }
+    for ( ; len >= FINGERPRINT_STRIPE; next += FINGERPRINT_STRIPE, len -= FINGERPRINT_STRIPE )
+        addStripe( fp->lanes, next );
+    memcpy( fp->buffer, next, len );
+    fp->buffered = len;
+}
+
+uint64_t finishFingerprint( Fingerprint const *fp )
+{
+    uint64_t const *lanes = fp->lanes;
+    uint64_t hash;
+    if ( fp->length >= FINGERPRINT_STRIPE ) {
+        hash = rotateLeft( lanes[ 0 ], 1 ) + rotateLeft( lanes[ 1 ], 7 ) + rotateLeft( lanes[ 2 ], 12 ) +
+               rotateLeft( lanes[ 3 ], 18 );
+        for ( int i = 0; i < 4; i++ )
+            hash = mergeLane( hash, lanes[ i ] );
+    } else {
+        hash = PRIME_5;
+    }
+    hash += fp->length;
+
+    //the bytes short of a stripe go in 8, then 4, then 1 at a time
+    unsigned char const *tail = fp->buffer;
+    int left = fp->buffered;
+    for ( ; left >= 8; tail += 8, left -= 8 ) {
+        hash ^= mixLane( 0, read64( tail ) );
+        hash = rotateLeft( hash, 27 ) * PRIME_1 + PRIME_4;
+    }
+    if ( left >= 4 ) {
+        hash ^= read32( tail ) * PRIME_1;
+        hash = rotateLeft( hash, 23 ) * PRIME_2 + PRIME_3;
+        tail += 4;
+        left -= 4;
+    }
+    for ( ; left > 0; tail++, left-- ) {
+        hash ^= *tail * PRIME_5;
+        hash = rotateLeft( hash, 11 ) * PRIME_1;
+    }
+
+    //every bit of the result depends on every bit of the lanes
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    return hash ^ ( hash >> 32 );
+}
+
+void benchmarkFingerprint( FILE *out )
+{
+    //the words of the list, each followed by a line-feed, as they are read
+    int n = lexiconSize();
+    int len = wordLength();
+    long size = (long) n * ( len + 1 );
+    char *text = countedMalloc( ALLOC_SESSION, size );
+    char *copy = countedMalloc( ALLOC_SESSION, size );
+    for ( int i = 0; i < n; i++ ) {
+        memcpy( text + (long) i * ( len + 1 ), lexiconWord( i ), len );
+        text[ (long) i * ( len + 1 ) + len ] = '\n';
+    }
+    long passes = BENCH_BYTES / size + 1;
+    double gigabytes = (double) passes * size / 1e9;
+
+    //adding up one byte of each copy keeps the copies from being left out
+    long start = monotonicNanos();
+    long copied = 0;
+    for ( long p = 0; p < passes; p++ ) {
+        memcpy( copy, text, size );
+        copied += copy[ p % size ];
+    }
+    double copyNanos = monotonicNanos() - start;
+
+    start = monotonicNanos();
+    uint64_t fnv = FNV_OFFSET_BASIS;
+    for ( long p = 0; p < passes; p++ )
+        for ( long i = 0; i < size; i++ )
+            fnv = ( fnv ^ (unsigned char) text[ i ] ) * FNV_PRIME;
+    double fnvNanos = monotonicNanos() - start;
+
+    start = monotonicNanos();
+    Fingerprint whole;
+    startFingerprint( &whole );
+    for ( long p = 0; p < passes; p++ )
+        addToFingerprint( &whole, text, size );
+    uint64_t wholeHash = finishFingerprint( &whole );
+    double wholeNanos = monotonicNanos() - start;
+
+    //adding one pass in uneven pieces must give the same fingerprint as in one
+    Fingerprint once, pieces;
+    startFingerprint( &once );
+    addToFingerprint( &once, text, size );
+    startFingerprint( &pieces );
+    for ( long i = 0, piece = 1; i < size; i += piece, piece = piece % FINGERPRINT_STRIPE + 1 )
+        addToFingerprint( &pieces, text + i, piece < size - i ? piece : size - i );
+
+    fprintf( out, "%ld bytes of words, %ld passes, %ld checksum of copies\n", size, passes, copied );
+    fprintf( out, "%-22s %10s\n", "method", "GB/s" );
+    fprintf( out, "%-22s %10.2f\n", "memcpy", gigabytes / ( copyNanos / 1e9 ) );
+    fprintf( out, "%-22s %10.2f\n", "fnv-1a", gigabytes / ( fnvNanos / 1e9 ) );
+    fprintf( out, "%-22s %10.2f\n", "fingerprint", gigabytes / ( wholeNanos / 1e9 ) );
+    fprintf( out, "fnv-1a %016lx, fingerprint %016lx\n", (unsigned long) fnv, (unsigned long) wholeHash );
+    if ( finishFingerprint( &once ) != finishFingerprint( &pieces ) )
+        fprintf( out, "Fingerprints differ: %016lx in one piece, %016lx in pieces\n",
+                 (unsigned long) finishFingerprint( &once ), (unsigned long) finishFingerprint( &pieces ) );
+
+    countedFree( ALLOC_SESSION, copy );
+    countedFree( ALLOC_SESSION, text );
+}
@@ -0,0 +1,65 @@
+/**
+ * @file fingerprint.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-20
+ *
+ * A fast 64-bit hash of a stream of bytes, used to tie everything built
+ * from a word list to the exact words it was built from. Bytes are taken
+ * 32 at a time into four independent lanes, so the work of one block never
+ * waits on the block before it, and any bytes short of a block wait in a
+ * buffer for the next ones. It follows the xxHash64 construction, so
+ * adding bytes in any number of pieces gives the hash of them all at once.
+ *
+ */
+#include <stdint.h>
+#include <stdio.h>
+
+/** Number of bytes hashed at a time, 8 in each of the four lanes */
+#define FINGERPRINT_STRIPE 32
+
+/** The state of a fingerprint being computed */
+typedef struct {
+    /** The four lanes */
+    uint64_t lanes[ 4 ];
+
+    /** Bytes waiting for a whole stripe, and how many there are */
+    unsigned char buffer[ FINGERPRINT_STRIPE ];
+    int buffered;
+
+    /** Number of bytes added so far */
+    uint64_t length;
+} Fingerprint;
+
+/**
+ * Starts a fingerprint of no bytes.
+ *
+ * @param fp the fingerprint
+ */
+void startFingerprint( Fingerprint *fp );
+
+/**
+ * Adds bytes to a fingerprint.
+ *
+ * @param fp the fingerprint
+ * @param bytes the bytes
+ * @param len the number of bytes
+ */
+void addToFingerprint( Fingerprint *fp, void const *bytes, long len );
+
+/**
+ * Returns the fingerprint of every byte added so far. More bytes can
+ * still be added afterwards.
+ *
+ * @param fp the fingerprint
+ * @return uint64_t the fingerprint
+ */
+uint64_t finishFingerprint( Fingerprint const *fp );
+
+/**
+ * Measures how fast the words of the list in use are fingerprinted in one
+ * piece, the way a list is after it loads, against copying them and
+ * against the FNV-1a hash, and prints the throughput of each.
+ *
+ * @param out the file the results are printed to
+ */
+void benchmarkFingerprint( FILE *out );
@@ -0,0 +1,170 @@
+/**
+ * @file hintcache.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-10
+ *
+ * Remembers the best guess for game states that have been solved before.
+ * A state is its set of remaining candidates, so games that got there by
+ * different guesses share one entry, and it is looked up by a hash of the
+ * set. The cache is split into shards with a lock each so threads rarely
+ * wait on each other, holds a fixed number of entries, and evicts the
+ * least recently used entry of a set when a new one needs room.
+ *
+ */
+#include "hintcache.h"
+#include "alloc.h"
+
+#include <stdatomic.h>
+#include <string.h>
+#include <pthread.h>
+
+/** Number of shards, each with its own lock */
+#define NUM_SHARDS 64
+
+/** Number of entries a key can go in within its shard */
+#define WAYS 4
+
+/** Multiplier mixing each candidate into the key */
+#define KEY_PRIME 0x9e3779b97f4a7c15UL
+
+/** One remembered state */
+typedef struct {
+    /** Key of the candidate set, 0 if the entry is empty */
+    uint64_t key;
+
+    /** Best guess for the set */
+    int guess;
+
+    /** When the entry was last used, by the shard's clock */
+    unsigned long used;
+} HintEntry;
+
+/** One shard: sets of WAYS entries and a lock over them */
+typedef struct {
+    pthread_mutex_t lock;
+    HintEntry *entries;
+    unsigned long clock;
+} Shard;
+
+/** The shards, and the number of sets of WAYS entries in each */
+static Shard shards[ NUM_SHARDS ];
+static long setsPerShard;
+
+/** Counts of how the cache has done */
+static atomic_long hits;
+static atomic_long misses;
+static atomic_long evictions;
+
+/**
+ * Finalizes a hash so every bit depends on every input bit.
+ *
+ * @param x the value being mixed
+ * @return uint64_t the mixed value
+ */
+static uint64_t mix( uint64_t x )
+{
+    x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9UL;
+    x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111ebUL;
+    return x ^ ( x >> 31 );
+}
+
+/**
+ * Finds the set of entries a key goes in, and locks its shard. The low
+ * bits choose the shard and the next bits the set within it.
+ *
+ * @param key the key
+ * @return HintEntry* the first entry of its set
+ */
+static HintEntry *lockSet( uint64_t key )
+{
+    Shard *shard = &shards[ key % NUM_SHARDS ];
+    pthread_mutex_lock( &shard->lock );
+    return shard->entries + ( key / NUM_SHARDS ) % setsPerShard * WAYS;
+}
+
+void initHintCache( long entries )
+{
+    setsPerShard = ( entries + NUM_SHARDS * WAYS - 1 ) / ( NUM_SHARDS * WAYS );
+    for ( int s = 0; s < NUM_SHARDS; s++ ) {
+        pthread_mutex_init( &shards[ s ].lock, NULL );
+        shards[ s ].entries = countedMalloc( ALLOC_INDEX, setsPerShard * WAYS * sizeof( HintEntry ) );
+        memset( shards[ s ].entries, 0, setsPerShard * WAYS * sizeof( HintEntry ) );
+        shards[ s ].clock = 0;
+    }
+}
+
+uint64_t candidateSetKey( int const candidates[], int count )
+{
+    uint64_t key = mix( count );
+    for ( int i = 0; i < count; i++ )
+        key = ( key ^ (uint64_t) candidates[ i ] ) * KEY_PRIME;
+
+    //0 marks an empty entry
+    key = mix( key );
+    return key == 0 ? 1 : key;
+}
+
+bool lookupHint( uint64_t key, int *guess )
+{
+    if ( setsPerShard == 0 )
+        return false;
+
+    Shard *shard = &shards[ key % NUM_SHARDS ];
+    HintEntry *set = lockSet( key );
+    bool found = false;
+    for ( int w = 0; w < WAYS && !found; w++ ) {
+        if ( set[ w ].key == key ) {
+            *guess = set[ w ].guess;
+            set[ w ].used = ++shard->clock;
+            found = true;
+        }
+    }
+    pthread_mutex_unlock( &shard->lock );
+
+    atomic_fetch_add( found ? &hits : &misses, 1 );
+    return found;
+}
+
+void storeHint( uint64_t key, int guess )
+{
+    if ( setsPerShard == 0 )
+        return;
+
+    Shard *shard = &shards[ key % NUM_SHARDS ];
+    HintEntry *set = lockSet( key );
+
+    //take the entry already holding the key, or an empty one, or else the
+    //least recently used; empty entries were never used so they come first
+    int victim = 0;
+    for ( int w = 0; w < WAYS; w++ ) {
+        if ( set[ w ].key == key ) {
+            victim = w;
+            break;
+        }
+        if ( set[ w ].used < set[ victim ].used )
+            victim = w;
+    }
+
+    if ( set[ victim ].key != 0 && set[ victim ].key != key )
+        atomic_fetch_add( &evictions, 1 );
+    set[ victim ] = (HintEntry) { key, guess, ++shard->clock };
+    pthread_mutex_unlock( &shard->lock );
+}
+
+void hintCacheStats( long *hitCount, long *missCount, long *evictionCount )
+{
+    *hitCount = atomic_load( &hits );
+    *missCount = atomic_load( &misses );
+    *evictionCount = atomic_load( &evictions );
+}
+
+void forEachHint( void ( *visit )( void *ctx, uint64_t key, int guess ), void *ctx )
+{
+    for ( int s = 0; s < NUM_SHARDS && setsPerShard > 0; s++ ) {
+        pthread_mutex_lock( &shards[ s ].lock );
+        for ( long e = 0; e < setsPerShard * WAYS; e++ )
+            if ( shards[ s ].entries[ e ].key != 0 )
+                visit( ctx, shards[ s ].entries[ e ].key, shards[ s ].entries[ e ].guess );
+        pthread_mutex_unlock( &shards[ s ].lock );
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file hintcache.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-10
+ *
+ * Remembers the best guess for game states that have been solved before.
+ * A state is its set of remaining candidates, so games that got there by
+ * different guesses share one entry, and it is looked up by a hash of the
+ * set. The cache is split into shards with a lock each so threads rarely
+ * wait on each other, holds a fixed number of entries, and evicts the
+ * least recently used entry of a set when a new one needs room.
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Number of entries the cache holds unless sized otherwise */
+#define DEFAULT_HINT_CACHE 65536
+
+/**
+ * Makes room for the given number of entries, all empty. Nothing is cached
+ * until this is called.
+ *
+ * @param entries the most entries the cache holds
+ */
+void initHintCache( long entries );
+
+/**
+ * Returns the key of a set of candidates, the same for the same set.
+ *
+ * @param candidates the candidates, in increasing order
+ * @param count the number of candidates
+ * @return uint64_t the key
+ */
+uint64_t candidateSetKey( int const candidates[], int count );
+
+/**
+ * Looks up the best guess for a set of candidates.
+ *
+ * @param key the key of the set
+ * @param guess where the guess is stored if found
+ * @return true if the set is cached
+ * @return false if else
+ */
+bool lookupHint( uint64_t key, int *guess );
+
+/**
+ * Remembers the best guess for a set of candidates, evicting the least
+ * recently used entry it competes with if there is no free one.
+ *
+ * @param key the key of the set
+ * @param guess the best guess
+ */
+void storeHint( uint64_t key, int guess );
+
+/**
+ * Returns how the cache has done so far.
+ *
+ * @param hits where the number of lookups that found their set is stored
+ * @param misses where the number of lookups that did not is stored
+ * @param evictions where the number of entries evicted is stored
+ */
+void hintCacheStats( long *hits, long *misses, long *evictions );
+
+/**
+ * Calls visit with every entry in the cache, for saving it. storeHint
+ * puts saved entries back.
+ *
+ * @param visit called with ctx, the key of a set and its best guess
+ * @param ctx passed to visit
+ */
+void forEachHint( void ( *visit )( void *ctx, uint64_t key, int guess ), void *ctx );
@@ -7,6 +7,7 @@
  * user to guess the word for every game of wordle they have played.
  */
 #include "history.h"
+#include "trace.h"
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -49,6 +50,8 @@ static int nextInt( FILE *file ) {
 
 void updateScore( int guessCount ) {
 
+    TRACE1( score_update, guessCount );
+
     //set up the file scanner and creates the file if it does not exist
     FILE *fp; 
     if ( ( fp = fopen( "scores.txt" , "r" ) ) == NULL ) {
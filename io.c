@@ -76,6 +76,50 @@ bool readLine( FILE *fp, char str[], int n )
 
 }
 
+bool readLineBetween( FILE *fp, char str[], int min, int max, int *len )
+{
+
+    //read letters until the end of the line or file
+    int ch;
+    *len = 0;
+    while ( ( ch = getc( fp ) ) != '\n' && ch != EOF ) {
+
+        //a non-letter or one letter too many makes the file invalid
+        if ( ch < LOWERCASE_A || ch > LOWERCASE_Z || *len == max ) {
+            fprintf( stderr, "Invalid word file\n" );
+            fclose( fp );
+            exit( EXIT_FAILURE );
+        }
+
+        //build up the string
+        str[ ( *len )++ ] = ch;
+    }
+
+    //the word must not be too short, which also rejects empty lines
+    if ( *len < min ) {
+        fprintf( stderr, "Invalid word file\n" );
+        fclose( fp );
+        exit( EXIT_FAILURE );
+    }
+
+    //Add the null terminator to the string
+    str[ *len ] = NULL_TERMINATOR;
+
+    //if we have reached the end of file, or a line-feed right before it,
+    //there are no more words to read
+    if ( ch == EOF )
+        return false;
+
+    ch = getc( fp );
+    if ( ch == EOF )
+        return false;
+
+    //return the character to file if it was not EOF and return true indicating more words
+    ungetc( ch, fp );
+    return true;
+
+}
+
 void colorGreen()
 {
     printf( "%s", green );
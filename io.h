@@ -34,6 +34,21 @@
  */
 bool readLine( FILE *fp, char str[], int n );
 
+/**
+ * This function reads one word of min to max letters from the file fp
+ * and stores it as a string with pointer str. If a file has a line that
+ * is not min to max lowercase letters followed by a line-feed or EOF,
+ * exit the system with an error.
+ * @param fp the file being read from
+ * @param str the pointer where the word will be stored, with room for max letters
+ * @param min the fewest letters a word may have
+ * @param max the most letters a word may have
+ * @param len where the number of letters in the word is stored
+ * @return true if there are more lines to read
+ * @return false if there are no more lines to read
+ */
+bool readLineBetween( FILE *fp, char str[], int min, int max, int *len );
+
 /**
  * Outputs the ANSI Escape sequence for the color green
  */
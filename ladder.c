@@ -0,0 +1,341 @@
+/**
+ * @file ladder.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-28
+ *
+ * Finds word ladders: the shortest chain of words from one word to another
+ * where each word differs from the one before it in exactly one letter.
+ * The graph of words one letter apart is built by grouping words that are
+ * equal once one position is blanked out, stored in compressed sparse row
+ * form, and searched with a breadth-first search from both ends at once.
+ * The graph can be saved to a cache file and loaded back instead of rebuilt.
+ *
+ */
+#include "ladder.h"
+#include "lexicon.h"
+#include "alloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/** Marks the start of a graph cache file */
+#define CACHE_MAGIC "WLADDER2"
+
+/** Number of bytes in CACHE_MAGIC */
+#define MAGIC_LEN 8
+
+/** The header at the start of a graph cache file */
+typedef struct {
+    char magic[ MAGIC_LEN ];
+
+    /** Number of words and their length in the list the graph was built from */
+    int32_t words;
+    int32_t wordLen;
+
+    /** Fingerprint of the list the graph was built from */
+    uint64_t fingerprint;
+
+    /** Number of directed edges */
+    int64_t edges;
+} CacheHeader;
+
+/** A word with one position blanked out, and the word it came from */
+typedef struct {
+    uint64_t key;
+    int word;
+} Bucketed;
+
+/** The number of words in the graph */
+static int numWords;
+
+/** Neighbors of word i are neighbors[ offsets[ i ] ] to neighbors[ offsets[ i + 1 ] - 1 ] */
+static int64_t *offsets;
+static int *neighbors;
+
+/**
+ * Packs a word into an integer with a byte per letter, leaving out the
+ * letter at position skip, so words that differ only there pack the same.
+ *
+ * @param word the word being packed
+ * @param skip the position being blanked out
+ * @return uint64_t the packed word
+ */
+static uint64_t blankedKey( char const word[], int skip )
+{
+    uint64_t value = 0;
+    for ( int i = 0; word[ i ]; i++ )
+        if ( i != skip )
+            value |= (uint64_t) (unsigned char) word[ i ] << ( 8 * i );
+    return value;
+}
+
+/**
+ * Orders bucketed words by key, for qsort.
+ *
+ * @param a the first bucketed word
+ * @param b the second bucketed word
+ * @return int negative, zero or positive like strcmp
+ */
+static int compareKeys( void const *a, void const *b )
+{
+    Bucketed const *x = a, *y = b;
+    if ( x->key != y->key )
+        return x->key < y->key ? -1 : 1;
+    return x->word - y->word;
+}
+
+/**
+ * Builds the graph. For each position, words are sorted by their key with
+ * that position blanked out, so each run of equal keys is a group of words
+ * that differ only at that position, and every pair in a group is an edge.
+ * Two words one letter apart share exactly one such group, so no edge is
+ * added twice. The first pass counts each word's edges, the second fills
+ * them in.
+ */
+static void buildGraph()
+{
+    int len = wordLength();
+    Bucketed *buckets = countedMalloc( ALLOC_INDEX, numWords * sizeof( Bucketed ) );
+
+    offsets = countedMalloc( ALLOC_INDEX, ( numWords + 1 ) * sizeof( int64_t ) );
+    memset( offsets, 0, ( numWords + 1 ) * sizeof( int64_t ) );
+    int64_t *fill = countedMalloc( ALLOC_INDEX, numWords * sizeof( int64_t ) );
+
+    for ( int pass = 0; pass < 2; pass++ ) {
+        for ( int skip = 0; skip < len; skip++ ) {
+            for ( int i = 0; i < numWords; i++ )
+                buckets[ i ] = (Bucketed) { blankedKey( lexiconWord( i ), skip ), i };
+            qsort( buckets, numWords, sizeof( Bucketed ), compareKeys );
+
+            //walk the runs of equal keys
+            for ( int start = 0, end; start < numWords; start = end ) {
+                for ( end = start + 1; end < numWords && buckets[ end ].key == buckets[ start ].key; end++ )
+                    ;
+
+                for ( int a = start; a < end; a++ ) {
+                    if ( pass == 0 ) {
+                        offsets[ buckets[ a ].word + 1 ] += end - start - 1;
+                        continue;
+                    }
+                    for ( int b = start; b < end; b++ )
+                        if ( a != b )
+                            neighbors[ fill[ buckets[ a ].word ]++ ] = buckets[ b ].word;
+                }
+            }
+        }
+
+        //after counting, turn the counts into offsets and make room for the edges
+        if ( pass == 0 ) {
+            for ( int i = 0; i < numWords; i++ )
+                offsets[ i + 1 ] += offsets[ i ];
+            memcpy( fill, offsets, numWords * sizeof( int64_t ) );
+            neighbors = countedMalloc( ALLOC_INDEX, ( offsets[ numWords ] + 1 ) * sizeof( int ) );
+        }
+    }
+
+    countedFree( ALLOC_INDEX, fill );
+    countedFree( ALLOC_INDEX, buckets );
+}
+
+/**
+ * Checks that a graph read from a cache can be searched without reading
+ * out of bounds: every word's edges start where the previous word's end
+ * and stop at the number of edges, and every neighbor is a word.
+ *
+ * @param edges the number of edges the cache holds
+ * @return true if the offsets and neighbors are consistent
+ * @return false if else
+ */
+static bool validGraph( long edges )
+{
+    if ( offsets[ 0 ] != 0 || offsets[ numWords ] != edges )
+        return false;
+    for ( int i = 0; i < numWords; i++ )
+        if ( offsets[ i + 1 ] < offsets[ i ] )
+            return false;
+    for ( long e = 0; e < edges; e++ )
+        if ( neighbors[ e ] < 0 || neighbors[ e ] >= numWords )
+            return false;
+    return true;
+}
+
+/**
+ * Loads the graph from a cache file, if the file holds the graph of this
+ * list, which its fingerprint tells, and the graph in it is whole and
+ * consistent.
+ *
+ * @param path the cache file
+ * @return true if the graph was loaded
+ * @return false if the file is missing, damaged or does not match the list
+ */
+static bool loadGraph( char const path[] )
+{
+    FILE *fp = fopen( path, "rb" );
+    if ( fp == NULL )
+        return false;
+
+    //the file must be exactly as long as the header says, so a damaged
+    //count of edges is caught before room is made for them
+    fseek( fp, 0, SEEK_END );
+    long size = ftell( fp );
+    rewind( fp );
+
+    CacheHeader header;
+    bool ok = fread( &header, sizeof( header ), 1, fp ) == 1 && memcmp( header.magic, CACHE_MAGIC, MAGIC_LEN ) == 0 &&
+              header.fingerprint == lexiconFingerprint( currentLexicon() ) && header.words == numWords &&
+              header.wordLen == wordLength() && header.edges >= 0 &&
+              header.edges <= (long) numWords * numWords &&
+              size == (long) sizeof( header ) + ( numWords + 1L ) * (long) sizeof( int64_t ) + header.edges * (long) sizeof( int );
+
+    if ( ok ) {
+        offsets = countedMalloc( ALLOC_INDEX, ( numWords + 1 ) * sizeof( int64_t ) );
+        neighbors = countedMalloc( ALLOC_INDEX, ( header.edges + 1 ) * sizeof( int ) );
+        ok = fread( offsets, sizeof( int64_t ), numWords + 1, fp ) == numWords + 1 &&
+             fread( neighbors, sizeof( int ), header.edges, fp ) == header.edges && validGraph( header.edges );
+        if ( !ok ) {
+            countedFree( ALLOC_INDEX, offsets );
+            countedFree( ALLOC_INDEX, neighbors );
+        }
+    }
+
+    fclose( fp );
+    return ok;
+}
+
+/**
+ * Writes the graph to a cache file. A cache that cannot be written is
+ * only reported, the graph is still usable.
+ *
+ * @param path the cache file
+ */
+static void saveGraph( char const path[] )
+{
+    FILE *fp = fopen( path, "wb" );
+    if ( fp == NULL ) {
+        fprintf( stderr, "Can't write the graph cache: %s\n", path );
+        return;
+    }
+
+    CacheHeader header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.magic, CACHE_MAGIC, MAGIC_LEN );
+    header.words = numWords;
+    header.wordLen = wordLength();
+    header.fingerprint = lexiconFingerprint( currentLexicon() );
+    header.edges = offsets[ numWords ];
+
+    if ( fwrite( &header, sizeof( header ), 1, fp ) != 1 ||
+         fwrite( offsets, sizeof( int64_t ), numWords + 1, fp ) != numWords + 1 ||
+         fwrite( neighbors, sizeof( int ), header.edges, fp ) != header.edges )
+        fprintf( stderr, "Can't write the graph cache: %s\n", path );
+
+    fclose( fp );
+}
+
+/**
+ * Expands every word of one side's frontier by one step. Returns the word
+ * where the two searches meet as soon as it is reached.
+ *
+ * @param frontier the words at the edge of this side's search
+ * @param size the number of words in frontier, updated to the new frontier
+ * @param next where the new frontier is written
+ * @param parent this side's parent of every reached word, -1 if unreached
+ * @param otherParent the other side's parents
+ * @return int the word where the searches meet, or -1
+ */
+static int expand( int frontier[], int *size, int next[], int parent[], int const otherParent[] )
+{
+    int nextSize = 0;
+    for ( int f = 0; f < *size; f++ ) {
+        int word = frontier[ f ];
+        for ( int64_t e = offsets[ word ]; e < offsets[ word + 1 ]; e++ ) {
+            int neighbor = neighbors[ e ];
+            if ( parent[ neighbor ] != -1 )
+                continue;
+            parent[ neighbor ] = word;
+            if ( otherParent[ neighbor ] != -1 )
+                return neighbor;
+            next[ nextSize++ ] = neighbor;
+        }
+    }
+    *size = nextSize;
+    return -1;
+}
+
+void prepareLadder( char const cachePath[] )
+{
+    numWords = lexiconSize();
+    if ( cachePath != NULL && loadGraph( cachePath ) )
+        return;
+
+    buildGraph();
+    if ( cachePath != NULL )
+        saveGraph( cachePath );
+}
+
+bool printLadder( FILE *out, char const from[], char const to[] )
+{
+    //a full word is a prefix of exactly one word in a list of one length
+    int start, goal;
+    if ( strlen( from ) != wordLength() || prefixRange( from, &start ) != 1 ||
+         strlen( to ) != wordLength() || prefixRange( to, &goal ) != 1 ) {
+        fprintf( out, "Both words must be in the word list\n" );
+        return false;
+    }
+
+    //each side keeps its own parents and frontiers; the start and goal are
+    //their own parents so they count as reached
+    int *forward = countedMalloc( ALLOC_SESSION, numWords * sizeof( int ) );
+    int *backward = countedMalloc( ALLOC_SESSION, numWords * sizeof( int ) );
+    int *frontiers[ 2 ][ 2 ];
+    for ( int side = 0; side < 2; side++ )
+        for ( int k = 0; k < 2; k++ )
+            frontiers[ side ][ k ] = countedMalloc( ALLOC_SESSION, numWords * sizeof( int ) );
+    for ( int i = 0; i < numWords; i++ )
+        forward[ i ] = backward[ i ] = -1;
+    forward[ start ] = start;
+    backward[ goal ] = goal;
+
+    int sizes[ 2 ] = { 1, 1 };
+    frontiers[ 0 ][ 0 ][ 0 ] = start;
+    frontiers[ 1 ][ 0 ][ 0 ] = goal;
+    int current[ 2 ] = { 0, 0 };
+
+    //always grow the smaller frontier, which keeps both searches shallow
+    int meet = start == goal ? start : -1;
+    while ( meet == -1 && sizes[ 0 ] > 0 && sizes[ 1 ] > 0 ) {
+        int side = sizes[ 0 ] <= sizes[ 1 ] ? 0 : 1;
+        int *parent = side == 0 ? forward : backward;
+        int *other = side == 0 ? backward : forward;
+        meet = expand( frontiers[ side ][ current[ side ] ], &sizes[ side ], frontiers[ side ][ 1 - current[ side ] ], parent, other );
+        current[ side ] = 1 - current[ side ];
+    }
+
+    if ( meet == -1 ) {
+        fprintf( out, "No ladder from %s to %s\n", from, to );
+    } else {
+        //walk back to the start, then print forward and on to the goal
+        int *path = frontiers[ 0 ][ 0 ];
+        int steps = 0;
+        for ( int w = meet; w != start; w = forward[ w ] )
+            path[ steps++ ] = w;
+        path[ steps++ ] = start;
+        for ( int i = steps - 1; i >= 0; i-- )
+            fprintf( out, "%s\n", lexiconWord( path[ i ] ) );
+        for ( int w = meet; w != goal; ) {
+            w = backward[ w ];
+            fprintf( out, "%s\n", lexiconWord( w ) );
+            steps++;
+        }
+        fprintf( out, "%d steps\n", steps - 1 );
+    }
+
+    countedFree( ALLOC_SESSION, forward );
+    countedFree( ALLOC_SESSION, backward );
+    for ( int side = 0; side < 2; side++ )
+        for ( int k = 0; k < 2; k++ )
+            countedFree( ALLOC_SESSION, frontiers[ side ][ k ] );
+
+    return meet != -1;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file ladder.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-28
+ *
+ * Finds word ladders: the shortest chain of words from one word to another
+ * where each word differs from the one before it in exactly one letter.
+ * The graph of words one letter apart is built by grouping words that are
+ * equal once one position is blanked out, stored in compressed sparse row
+ * form, and searched with a breadth-first search from both ends at once.
+ * The graph can be saved to a cache file and loaded back instead of rebuilt.
+ *
+ */
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * Builds the graph over the sorted list of words chosen in the lexicon,
+ * or loads it from cachePath if that file holds the graph of this list.
+ * A freshly built graph is written to cachePath.
+ *
+ * @param cachePath the graph cache file, or NULL to always build
+ */
+void prepareLadder( char const cachePath[] );
+
+/**
+ * Prints the shortest ladder between two words of the list, one word
+ * per line, or a message if there is none.
+ *
+ * @param out the file the ladder is printed to
+ * @param from the word the ladder starts at
+ * @param to the word the ladder ends at
+ * @return true if a ladder was found
+ * @return false if either word is not in the list or they are not connected
+ */
+bool printLadder( FILE *out, char const from[], char const to[] );
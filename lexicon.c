@@ -11,6 +11,12 @@
  */
 #include "lexicon.h"
 #include "io.h"
+#include "metrics.h"
+#include "alloc.h"
+#include "trace.h"
+#include "permute.h"
+#include "normalize.h"
+#include "fingerprint.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -22,23 +28,51 @@
 /** Initial capacity of the word list */
 #define INITIAL_CAPACITY 10
 
-/** The global list of all words */
-static char **wordList;
+/** The words of one length, each stored with its null terminator one after another */
+typedef struct {
+    /** Storage for the words, len + 1 bytes apart */
+    char *words;
 
-/** The global length of the list of words */
-static int wordListLen;
+    /** The list of the words, pointing into words */
+    char **list;
+
+    /** The number of words */
+    int count;
+
+    /** The number of words there is room for in words */
+    int capacity;
+} Partition;
+
+/** Every word read from one word list file, never changed once loaded */
+struct Lexicon {
+    /** The words of every length, indexed by length */
+    Partition partitions[ MAX_WORD_LEN + 1 ];
+
+    /** The number of words of every length */
+    int total;
+
+    /** Fingerprint of the words of each length, in file order */
+    uint64_t fingerprint;
+};
+
+/** The session the shorthand functions work on */
+static Session *inUse;
+
+/** Whether lists are cleaned up before they are checked */
+static bool lenient;
 
 /**
  * Implements the binary search algorithm to quickly search for words in the list.
  * Recursivley searches through wordList from low to high index. Cuts off halves of the 
  * list if the element is not in that half. Instance size is halved everytime -> O(logn)
+ * @param wordList the sorted list being searched
  * @param word the target word being searched for in the list
  * @param low the lowest index being considred in wordList
  * @param high the highest index being considered in wordList
  * @return true if the word exists in wordList
  * @return false if the word does not exist in wordList
  */
-static bool binarySearch( char const word[], long low, long high )
+static bool binarySearch( char *const *wordList, char const word[], long low, long high )
 {
     //if low > high, then entire list has been searched
     //and key was not found (base case)
@@ -56,14 +90,38 @@ static bool binarySearch( char const word[], long low, long high )
         
         //if middle element is greater than word, word is in left
         else if ( result > 0 )
-            return binarySearch( word, low, mid - 1 );
+            return binarySearch( wordList, word, low, mid - 1 );
 
         //vice versa
         else 
-            return binarySearch( word, mid + 1, high );
+            return binarySearch( wordList, word, mid + 1, high );
     }
 }
 
+/**
+ * Finds the first word of a session whose first len letters are not less
+ * than prefix, or, if after is true, greater than prefix. Halves the
+ * range every step, like binarySearch.
+ * @param session the session
+ * @param prefix the prefix being searched for
+ * @param len the number of letters in prefix
+ * @param after whether words starting with prefix count as less than it
+ * @return int the index of the first such word, or the number of words if none
+ */
+static int prefixBound( Session const *session, char const prefix[], int len, bool after )
+{
+    int low = 0, high = session->count;
+    while ( low < high ) {
+        int mid = ( low + high ) / 2;
+        int result = strncmp( session->list[ mid ], prefix, len );
+        if ( result < 0 || ( after && result == 0 ) )
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
 /**
  * MergeSort's helper merger function. Merges all the elements from 
  * left and right in sorted order into the list. 
@@ -109,7 +167,7 @@ static char **copyArray( char **origList, long start, long end )
 {
     //calculate length of new list and allocate enough memory for it
     long newListLen = end - start + 1;
-    char **newList = malloc( newListLen * sizeof(char *) );
+    char **newList = countedMalloc( ALLOC_INDEX, newListLen * sizeof(char *) );
 
     //copy elements from the original list into the new list
     for ( int i = 0; i < newListLen; i++ )
@@ -150,91 +208,308 @@ static void mergeSort( char **list, long n )
         merge( left, leftLength, right, rightLength, list, n );
 
         //free up memory with unneeded left and right lists
-        free( left );
-        free( right );
+        countedFree( ALLOC_INDEX, left );
+        countedFree( ALLOC_INDEX, right );
     }
 }
 
-void readWords( char const filename[] )
+/**
+ * Sorts the words of every length of a lexicon in alphabetical order.
+ * Then checks if there are any duplicates in the list 
+ * and exits with an error if there are any.
+ * @param lexicon the lexicon being sorted
+ */
+static void sortLexicon( Lexicon *lexicon )
 {
 
-    //set up the file scanner and exit if cannot open
-    FILE *fp; 
-    if ( ( fp = fopen( filename, "r" ) ) == NULL ) {
+    TRACE1( sort_start, lexicon->total );
+    long start = monotonicNanos();
+
+    //every length has its own list, sorted on its own
+    for ( int len = MIN_WORD_LEN; len <= MAX_WORD_LEN; len++ ) {
+        Partition *part = &lexicon->partitions[ len ];
+        if ( part->count == 0 )
+            continue;
+
+        //call the mergeSort recursive algorithm with the starting parameters
+        mergeSort( part->list, part->count );
+
+        //checking for dupliactes in a sorted list entails 
+        //checking if neighbors are identical, hence it is O(n)
+        for ( int i = 0; i < part->count - 1; i++ ) {
+            if ( strcmp( part->list[ i ], part->list[ i + 1 ] ) == 0 ) {
+                fprintf( stderr, "Invalid word file\n" );
+                exit( EXIT_FAILURE );
+            }
+        }
+    }
+
+    TRACE2( sort_end, lexicon->total, monotonicNanos() - start );
+
+}
+
+Lexicon *loadLexicon( char const filename[], bool mixed )
+{
+
+    TRACE1( lexicon_load_start, filename );
+    long start = monotonicNanos();
+    int min = mixed ? MIN_WORD_LEN : WORD_LEN;
+    int max = mixed ? MAX_WORD_LEN : WORD_LEN;
+
+    //set up the file scanner and exit if cannot open, scanning a cleaned
+    //copy of the file if lenient
+    FILE *fp;
+    char *cleaned = NULL;
+    if ( ( fp = lenient ? openNormalized( filename, &cleaned ) : fopen( filename, "r" ) ) == NULL ) {
         fprintf( stderr, "Can't open the word list: %s\n", filename );
         exit( EXIT_FAILURE );
     }
 
-    //initialize the word list as a pointer to char pointers (array of strings)
-    //with the initial capacity of 10 char pointers, and a length of zero
-    wordList = (char **) malloc( INITIAL_CAPACITY * sizeof(char *) );
-    wordListLen = 0;
-    int capacity = INITIAL_CAPACITY;
+    //the words of each length are stored in one block of memory that grows as words
+    //are read, starting with no room at all so unused lengths cost nothing
+    Lexicon *lexicon = countedMalloc( ALLOC_LEXICON, sizeof( Lexicon ) );
+    for ( int len = 0; len <= MAX_WORD_LEN; len++ )
+        lexicon->partitions[ len ] = (Partition) { NULL, NULL, 0, 0 };
+    lexicon->total = 0;
 
     //continue to scan string as long as there are more strings in the file
     //using this boolean flag allows the program to still execute the loop one 
     //more time if readLine returns false.
+    char str[ MAX_WORD_LEN + 1 ];
     bool getAnotherLine = true;
     while( getAnotherLine ) {
 
-        //the length of any string in the array is word_len + 1 (for the null terminator at the end)
-        char *str = (char *) malloc( ( WORD_LEN + 1 ) * ( sizeof(char) ) );
-
-        //read in a word into str and flag if another line should be read
-        getAnotherLine = readLine( fp, str, WORD_LEN );
-
-        //if the array of strings is at capacity, double its capacity or 
-        //set the capacity to the word limit, whichever is lower
-        if ( wordListLen == capacity ) {
-            capacity = capacity > WORD_LIMIT / 2 ? WORD_LIMIT : capacity * 2;
-            wordList = (char **) realloc( wordList, capacity * sizeof( wordList[ 0 ] ) );
-        }
-
         //if the list's length is at the word limit, exit
-        if ( wordListLen == WORD_LIMIT ) {
+        if ( lexicon->total == WORD_LIMIT ) {
             fprintf( stderr, "Invalid word file\n" );
             fclose( fp );
             exit( EXIT_FAILURE );
         }
 
-        //add the string from readLine into the list
-        wordList[ wordListLen++ ] = str;
+        //read in a word and flag if another line should be read
+        int len;
+        getAnotherLine = readLineBetween( fp, str, min, max, &len );
+        Partition *part = &lexicon->partitions[ len ];
+
+        //if the block of words is at capacity, double its capacity or 
+        //set the capacity to the word limit, whichever is lower
+        if ( part->count == part->capacity ) {
+            part->capacity = part->capacity == 0 ? INITIAL_CAPACITY :
+                             part->capacity > WORD_LIMIT / 2 ? WORD_LIMIT : part->capacity * 2;
+            part->words = countedRealloc( ALLOC_LEXICON, part->words, part->capacity * ( len + 1 ) );
+        }
+
+        //add the word into its place in the block
+        memcpy( part->words + part->count++ * ( len + 1 ), str, len + 1 );
+        lexicon->total++;
+    }
+
+    fclose( fp );
+    countedFree( ALLOC_LEXICON, cleaned );
+
+    //each block of words goes into the fingerprint in one piece after its
+    //length and count, so equal lists match no matter how their file ends
+    Fingerprint fingerprint;
+    startFingerprint( &fingerprint );
+    for ( int len = min; len <= max; len++ ) {
+        Partition const *part = &lexicon->partitions[ len ];
+        if ( part->count == 0 )
+            continue;
+        int32_t shape[ 2 ] = { len, part->count };
+        addToFingerprint( &fingerprint, shape, sizeof( shape ) );
+        addToFingerprint( &fingerprint, part->words, (long) part->count * ( len + 1 ) );
+    }
+    lexicon->fingerprint = finishFingerprint( &fingerprint );
+
+    //the blocks have stopped moving, so the lists of words can now point into them
+    for ( int len = min; len <= max; len++ ) {
+        Partition *part = &lexicon->partitions[ len ];
+        if ( part->count == 0 )
+            continue;
+        part->list = countedMalloc( ALLOC_INDEX, part->count * sizeof( part->list[ 0 ] ) );
+        for ( int i = 0; i < part->count; i++ )
+            part->list[ i ] = part->words + i * ( len + 1 );
+    }
+
+    //the lists are sorted once here, so games sharing the lexicon only read it
+    sortLexicon( lexicon );
+
+    TRACE3( lexicon_load_end, filename, lexicon->total, monotonicNanos() - start );
+    return lexicon;
+
+}
+
+void freeLexicon( Lexicon *lexicon )
+{
+    for ( int len = 0; len <= MAX_WORD_LEN; len++ ) {
+        countedFree( ALLOC_LEXICON, lexicon->partitions[ len ].words );
+        countedFree( ALLOC_INDEX, lexicon->partitions[ len ].list );
     }
+    countedFree( ALLOC_LEXICON, lexicon );
+}
+
+uint64_t lexiconFingerprint( Lexicon const *lexicon )
+{
+    return lexicon->fingerprint;
+}
+
+int lexiconTotal( Lexicon const *lexicon )
+{
+    return lexicon->total;
+}
 
+void setLenient( bool clean )
+{
+    lenient = clean;
+}
+
+bool isLenient()
+{
+    return lenient;
 }
 
-void chooseWord( long seed, char word[ WORD_LEN + 1 ] )
+bool sameWords( Lexicon const *a, Lexicon const *b )
+{
+    if ( a->fingerprint != b->fingerprint || a->total != b->total )
+        return false;
+
+    //the blocks hold the words of each length in file order
+    for ( int len = MIN_WORD_LEN; len <= MAX_WORD_LEN; len++ ) {
+        Partition const *x = &a->partitions[ len ], *y = &b->partitions[ len ];
+        if ( x->count != y->count || memcmp( x->words, y->words, (size_t) x->count * ( len + 1 ) ) != 0 )
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Points a session at the words of one length of its lexicon.
+ * @param session the session
+ * @param len the length of the words
+ */
+static void viewLength( Session *session, int len )
+{
+    Partition const *part = &session->lexicon->partitions[ len ];
+    session->len = len;
+    session->list = part->list;
+    session->count = part->count;
+    session->words = part->words;
+}
+
+void openSession( Session *session, Lexicon *lexicon )
+{
+    session->lexicon = lexicon;
+    viewLength( session, WORD_LEN );
+}
+
+bool sessionSelectLength( Session *session, int len )
+{
+    if ( len < MIN_WORD_LEN || len > MAX_WORD_LEN || session->lexicon->partitions[ len ].count == 0 )
+        return false;
+
+    viewLength( session, len );
+    return true;
+}
+
+bool sessionContains( Session const *session, char const word[] )
+{
+    return binarySearch( session->list, word, 0, session->count - 1 );
+}
+
+int sessionPrefixRange( Session const *session, char const prefix[], int *first )
+{
+    int len = strlen( prefix );
+    *first = prefixBound( session, prefix, len, false );
+    return prefixBound( session, prefix, len, true ) - *first;
+}
+
+void sessionChooseWord( Session const *session, long seed, char word[] )
 {
     //calculate random index using given randomization formula
     //and pick the random word
-    long randomIndex = ( seed % wordListLen ) * MULTIPLIER % wordListLen;
-    char *chosenWord = wordList[ randomIndex ];
+    long randomIndex = ( seed % session->count ) * MULTIPLIER % session->count;
+    char const *chosenWord = session->words + randomIndex * ( session->len + 1 );
 
     //copy the chosen word to the given word
-    for ( int i = 0; i <= WORD_LEN; i++ )
+    for ( int i = 0; i <= session->len; i++ )
         word[ i ] = chosenWord[ i ];
     
 }
 
-bool inList( char const word[] )
+void sessionChooseScheduledWord( Session const *session, long seed, long round, char word[] )
 {
-    //calls binary search recursive algorithm with starting paramters
-    return binarySearch( word, 0, wordListLen - 1 );
+    //every pass through the list uses its own permutation, so the order
+    //changes from one pass to the next
+    long pass = round / session->count;
+    Permutation perm;
+    initPermutation( &perm, session->count, (long) ( (unsigned long) seed + (unsigned long) pass * MULTIPLIER ) );
+
+    //copy the word at this round's place in the permutation to the given word
+    long index = permute( &perm, round % session->count );
+    char const *chosenWord = session->words + index * ( session->len + 1 );
+    for ( int i = 0; i <= session->len; i++ )
+        word[ i ] = chosenWord[ i ];
 }
 
-void sort()
+void useSession( Session *session )
 {
+    inUse = session;
+    setLexiconSize( lexiconTotal( session->lexicon ) );
+}
 
-    //call the mergeSort recursive algorithm with the starting parameters
-    mergeSort( wordList, wordListLen );
+Session *currentSession()
+{
+    return inUse;
+}
 
-    //checking for dupliactes in a sorted list entails 
-    //checking if neighbors are identical, hence it is O(n)
-    for ( int i = 0; i < wordListLen - 1; i++ ) {
-        if ( strcmp( wordList[ i ], wordList[ i + 1 ] ) == 0 ) {
-            fprintf( stderr, "Invalid word file\n" );
-            exit( EXIT_FAILURE );
-        }
-    }
+Lexicon *currentLexicon()
+{
+    return inUse->lexicon;
+}
+
+bool selectLength( int len )
+{
+    return sessionSelectLength( inUse, len );
+}
+
+int wordLength()
+{
+    return inUse->len;
+}
+
+void chooseWord( long seed, char word[] )
+{
+    sessionChooseWord( inUse, seed, word );
+}
 
+void chooseScheduledWord( long seed, long round, char word[] )
+{
+    sessionChooseScheduledWord( inUse, seed, round, word );
+}
+
+bool inList( char const word[] )
+{
+    //searches the session's words and records how long the look up took
+    long start = monotonicNanos();
+    bool found = sessionContains( inUse, word );
+    long elapsed = monotonicNanos() - start;
+    observeLookup( elapsed );
+    TRACE3( lookup, word, found, elapsed );
+
+    return found;
+}
+
+int prefixRange( char const prefix[], int *first )
+{
+    return sessionPrefixRange( inUse, prefix, first );
+}
+
+int lexiconSize()
+{
+    return inUse->count;
+}
+
+char const *lexiconWord( int index )
+{
+    return inUse->list[ index ];
 }
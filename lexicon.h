@@ -9,29 +9,231 @@
  * 
  */
 #include <stdbool.h>
+#include <stdint.h>
 
 /** Maximum lengh of a word on the word list. */
 #define WORD_LEN 5
 
+/** Fewest letters a word may have in a list of mixed lengths. */
+#define MIN_WORD_LEN 2
+
+/** Most letters a word may have in a list of mixed lengths. */
+#define MAX_WORD_LEN 8
+
 /** Maximum number of words on the word list. */
 #define WORD_LIMIT 100000
 
+/** Every word read from one word list file, sorted and looked up as a unit */
+typedef struct Lexicon Lexicon;
+
 /**
- * Reads the words list from the file with name filename.
- * 
+ * One game's view of a lexicon: the length of words it plays with and
+ * those words. Any number of sessions can view one lexicon at once, since
+ * the lexicon never changes once loaded and everything a game chooses is
+ * kept here.
+ */
+typedef struct {
+    /** The lexicon viewed */
+    Lexicon *lexicon;
+
+    /** The length of the words chosen */
+    int len;
+
+    /** The words of that length in alphabetical order, and how many there are */
+    char **list;
+    int count;
+
+    /** The same words in the order of the file, len + 1 bytes apart */
+    char const *words;
+} Session;
+
+/**
+ * Reads a words list into a new lexicon, sorts the words of every length
+ * and checks them for duplicates. Exits with an error if the file is
+ * invalid. The lexicon does not change afterwards.
+ *
  * @param filename the filename that holds the input
+ * @param mixed if true, words may have MIN_WORD_LEN to MAX_WORD_LEN letters,
+ *              if false, only WORD_LEN letters
+ * @return Lexicon* the new lexicon
+ */
+Lexicon *loadLexicon( char const filename[], bool mixed );
+
+/**
+ * Sets whether lists loaded from now on are cleaned up before they are
+ * checked: letters lowercased, and carriage returns and other whitespace
+ * at the end of lines dropped. Lists are taken as they are by default.
+ *
+ * @param clean whether lists are cleaned up
+ */
+void setLenient( bool clean );
+
+/**
+ * Returns whether lists loaded from now on are cleaned up before they are
+ * checked, as set by setLenient.
+ *
+ * @return bool whether lists are cleaned up
+ */
+bool isLenient();
+
+/**
+ * Frees a lexicon from loadLexicon. No session may view it any longer.
+ *
+ * @param lexicon the lexicon being freed
  */
-void readWords( char const filename[] );
+void freeLexicon( Lexicon *lexicon );
+
+/**
+ * Returns the fingerprint of the words of each length of a lexicon in
+ * file order, taken once they were read. Lists with the same words in the
+ * same order have the same fingerprint, and anything built from a list records it so it
+ * is only used with that list.
+ *
+ * @param lexicon the lexicon
+ * @return uint64_t the fingerprint of its contents
+ */
+uint64_t lexiconFingerprint( Lexicon const *lexicon );
+
+/**
+ * Returns the number of words of every length in a lexicon.
+ *
+ * @param lexicon the lexicon
+ * @return int the number of words
+ */
+int lexiconTotal( Lexicon const *lexicon );
+
+/**
+ * Checks whether two lexicons hold exactly the same words, of every
+ * length and in the same order.
+ *
+ * @param a one lexicon
+ * @param b the other lexicon
+ * @return true if their words are the same
+ * @return false if else
+ */
+bool sameWords( Lexicon const *a, Lexicon const *b );
+
+/**
+ * Starts a session viewing the WORD_LEN words of a lexicon.
+ *
+ * @param session the session
+ * @param lexicon the lexicon it views
+ */
+void openSession( Session *session, Lexicon *lexicon );
+
+/**
+ * Chooses the words of the given length as the ones a session works on.
+ *
+ * @param session the session
+ * @param len the number of letters in the words
+ * @return true if its lexicon has words of that length
+ * @return false if else, in which case the chosen words do not change
+ */
+bool sessionSelectLength( Session *session, int len );
+
+/**
+ * Checks if the given word is one of a session's words. Unlike inList,
+ * the look up is not timed or recorded.
+ *
+ * @param session the session
+ * @param word the word being searched for
+ * @return true if the word exists
+ * @return false if else
+ */
+bool sessionContains( Session const *session, char const word[] );
+
+/**
+ * Finds the words of a session that start with the given prefix, like
+ * prefixRange.
+ *
+ * @param session the session
+ * @param prefix the letters the words start with
+ * @param first where the index of the first word with the prefix is stored
+ * @return int the number of words with the prefix
+ */
+int sessionPrefixRange( Session const *session, char const prefix[], int *first );
+
+/**
+ * Chooses a session's target word with the given seed, like chooseWord.
+ *
+ * @param session the session
+ * @param seed seed used to generate number
+ * @param word where the word should be stored, with room for len letters
+ */
+void sessionChooseWord( Session const *session, long seed, char word[] );
+
+/**
+ * Chooses a session's target word of a round of the schedule chosen by
+ * seed, like chooseScheduledWord.
+ *
+ * @param session the session
+ * @param seed chooses the schedule
+ * @param round the round of the schedule, counting from 0
+ * @param word where the word should be stored, with room for len letters
+ */
+void sessionChooseScheduledWord( Session const *session, long seed, long round, char word[] );
+
+/**
+ * Makes session the one every function below works on. Those functions
+ * are the game's shorthand for the session functions above.
+ *
+ * @param session the session to use
+ */
+void useSession( Session *session );
+
+/**
+ * Returns the session every function below works on.
+ *
+ * @return Session* the session in use
+ */
+Session *currentSession();
+
+/**
+ * Returns the lexicon of the session in use.
+ *
+ * @return Lexicon* the lexicon in use
+ */
+Lexicon *currentLexicon();
+
+/**
+ * Chooses the list of words of the given length as the list every
+ * other lexicon function works on, in the session in use.
+ *
+ * @param len the number of letters in the words
+ * @return true if the lexicon has words of that length
+ * @return false if else, in which case the chosen list does not change
+ */
+bool selectLength( int len );
+
+/**
+ * Returns the number of letters in the words of the chosen list.
+ *
+ * @return int the length of the words
+ */
+int wordLength();
 
 /**
  * This function choosees a word from the current word list 
  * randomly using the given seed to generate a pseudorandom number.
+ * Words are chosen by their place in the file, not in alphabetical order.
  * 
  * @param seed seed used to generate number
- * @param word where the random word should be stored
+ * @param word where the random word should be stored, with room for wordLength() letters
  */
 void chooseWord( long seed, char word[] );
 
+/**
+ * Chooses the target word of the given round of the schedule chosen by
+ * seed. The schedule goes through every word of the list exactly once,
+ * in a random order, before it goes through them all again in another
+ * order. Takes constant time and memory however long the list is.
+ *
+ * @param seed chooses the schedule
+ * @param round the round of the schedule, counting from 0
+ * @param word where the word should be stored, with room for wordLength() letters
+ */
+void chooseScheduledWord( long seed, long round, char word[] );
+
 /**
  * Checks if the given word is in the list of words.
  * 
@@ -42,8 +244,28 @@ void chooseWord( long seed, char word[] );
 bool inList( char const word[] );
 
 /**
- * Sorts the list of words in alphabetical order.
- * Then checks if there are any duplicates in the list 
- * and exits with an error if there are any.
+ * Finds the words of the sorted list that start with the given prefix.
+ * They sit next to each other in the sorted list, so two binary searches
+ * find where they begin and end.
+ *
+ * @param prefix the letters the words start with
+ * @param first where the index of the first word with the prefix is stored
+ * @return int the number of words with the prefix
+ */
+int prefixRange( char const prefix[], int *first );
+
+/**
+ * Returns the number of words in the list.
+ *
+ * @return int the number of words
+ */
+int lexiconSize();
+
+/**
+ * Returns the word at the given index of the list. Indices follow
+ * alphabetical order.
+ *
+ * @param index the index of the word, between 0 and lexiconSize() - 1
+ * @return char const* the word at that index
  */
-void sort();
+char const *lexiconWord( int index );
@@ -0,0 +1,346 @@
+/**
+ * @file metrics.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-08
+ *
+ * Collects runtime counters and histograms about the game (games played,
+ * guesses made, word look up latency, lexicon size) and serves them in the
+ * Prometheus text exposition format over a local Unix socket.
+ * Every thread counts into its own block of counters, so recording a
+ * metric never takes a lock.
+ *
+ */
+#include "metrics.h"
+
+#include <stdatomic.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+/** Number of nanoseconds in one second */
+#define NANOS_PER_SECOND 1000000000L
+
+/** Size of the buffer the metrics text is formatted into */
+#define RESPONSE_CAPACITY 8192
+
+/** Size of the buffer a scrape request is read into */
+#define REQUEST_CAPACITY 1024
+
+/** Number of pending connections the socket will queue */
+#define LISTEN_BACKLOG 8
+
+/** Seconds a scraper has to send its request and take the response */
+#define SCRAPE_TIMEOUT_SECONDS 2
+
+/** Bytes in a cache line, which no two threads' blocks share */
+#define CACHE_LINE 64
+
+/** Upper bounds (in nanoseconds) of the finite latency histogram buckets */
+static const long lookupBounds[ LOOKUP_BUCKETS ] = { 100, 250, 500, 1000, 2500, 5000, 10000, 100000 };
+
+/** Prometheus names of the counters, in the order of the Counter enum */
+static const char *counterNames[ NUM_COUNTERS ] = {
+    "wordle_games_started_total",
+    "wordle_games_finished_total",
+    "wordle_guesses_total",
+    "wordle_invalid_guesses_total"
+};
+
+/** Help text of the counters, in the order of the Counter enum */
+static const char *counterHelp[ NUM_COUNTERS ] = {
+    "Games that picked a target word.",
+    "Games the player solved.",
+    "Valid guesses made. rate() of this is guesses per second.",
+    "Guesses rejected as invalid."
+};
+
+/**
+ * The counters owned by one thread. Only the owning thread writes them, so
+ * increments are a relaxed load and store rather than a locked add, and the
+ * scraper only ever reads them. Each block starts on its own cache line and
+ * is padded to a whole number of them, so threads never write to the same line.
+ */
+typedef struct {
+    _Alignas( CACHE_LINE ) _Atomic long counters[ NUM_COUNTERS ];
+    _Atomic long lookupBuckets[ LOOKUP_BUCKETS + 1 ];
+    _Atomic long lookupSum;
+} ThreadMetrics;
+
+/** The blocks of counters handed out to threads */
+static ThreadMetrics blocks[ METRIC_MAX_THREADS ];
+
+/** The number of blocks that have been handed out */
+static _Atomic int blocksUsed;
+
+/** Shared block for threads beyond METRIC_MAX_THREADS, updated with atomic adds */
+static ThreadMetrics overflow;
+
+/** The block of counters belonging to the calling thread */
+static __thread ThreadMetrics *local;
+
+/** Number of words in the loaded lexicon */
+static _Atomic long lexiconSize;
+
+/** Time the process started collecting metrics, in seconds since the epoch */
+static time_t startTime;
+
+/** File descriptor of the listening socket */
+static int listenFd = -1;
+
+/**
+ * Returns the calling thread's block of counters, claiming one the first
+ * time the thread records a metric.
+ *
+ * @return ThreadMetrics* the block owned by the calling thread
+ */
+static ThreadMetrics *threadBlock()
+{
+    if ( local == NULL ) {
+        int slot = atomic_fetch_add( &blocksUsed, 1 );
+        local = slot < METRIC_MAX_THREADS ? &blocks[ slot ] : &overflow;
+    }
+    return local;
+}
+
+/**
+ * Adds amount to a counter of the calling thread. The owner is the only
+ * writer of its block, so a plain load and store is enough; the shared
+ * overflow block needs a real atomic add.
+ *
+ * @param value the counter being added to
+ * @param amount the amount to add
+ */
+static void add( _Atomic long *value, long amount )
+{
+    if ( local == &overflow )
+        atomic_fetch_add_explicit( value, amount, memory_order_relaxed );
+    else
+        atomic_store_explicit( value, atomic_load_explicit( value, memory_order_relaxed ) + amount, memory_order_relaxed );
+}
+
+/**
+ * Sums a counter across every thread's block.
+ *
+ * @param value the counter in the first block
+ * @return long the total across all blocks
+ */
+static long total( _Atomic long *value )
+{
+    //all blocks share a layout, so the counter sits at the same offset in each
+    size_t offset = (char *) value - (char *) &blocks[ 0 ];
+    int used = atomic_load( &blocksUsed );
+    if ( used > METRIC_MAX_THREADS )
+        used = METRIC_MAX_THREADS;
+
+    long sum = atomic_load_explicit( (_Atomic long *) ( (char *) &overflow + offset ), memory_order_relaxed );
+    for ( int i = 0; i < used; i++ )
+        sum += atomic_load_explicit( (_Atomic long *) ( (char *) &blocks[ i ] + offset ), memory_order_relaxed );
+    return sum;
+}
+
+/**
+ * Reads the resident memory of the process from /proc.
+ *
+ * @return long resident memory in bytes, or zero if it cannot be read
+ */
+static long residentBytes()
+{
+    FILE *fp = fopen( "/proc/self/statm", "r" );
+    if ( fp == NULL )
+        return 0;
+
+    long size = 0, resident = 0;
+    if ( fscanf( fp, "%ld %ld", &size, &resident ) != 2 )
+        resident = 0;
+    fclose( fp );
+
+    return resident * sysconf( _SC_PAGESIZE );
+}
+
+/**
+ * Appends formatted text to a buffer the way snprintf does, but stops at
+ * its capacity: text that does not fit is cut off, and the length returned
+ * is that of the text actually in the buffer, so the space left for the
+ * next call never goes negative.
+ *
+ * @param buf the buffer
+ * @param cap the capacity of buf
+ * @param len the length of the text already in buf, at most cap - 1
+ * @param format the format of the text, as for printf
+ * @return int the length of the text in buf afterwards, at most cap - 1
+ */
+static int appendText( char buf[], int cap, int len, char const *format, ... )
+{
+    va_list args;
+    va_start( args, format );
+    int written = vsnprintf( buf + len, cap - len, format, args );
+    va_end( args );
+
+    if ( written < 0 )
+        return len;
+    return written < cap - len ? len + written : cap - 1;
+}
+
+/**
+ * Formats every metric in the Prometheus text exposition format.
+ *
+ * @param buf where the text is written
+ * @param cap the capacity of buf
+ * @return int the length of the text written
+ */
+static int formatMetrics( char buf[], int cap )
+{
+    int len = 0;
+
+    for ( int i = 0; i < NUM_COUNTERS; i++ )
+        len = appendText( buf, cap, len, "# HELP %s %s\n# TYPE %s counter\n%s %ld\n",
+                          counterNames[ i ], counterHelp[ i ], counterNames[ i ], counterNames[ i ],
+                          total( &blocks[ 0 ].counters[ i ] ) );
+
+    //histogram buckets are reported cumulatively
+    len = appendText( buf, cap, len, "# HELP wordle_lookup_seconds Latency of word list look ups.\n"
+                                     "# TYPE wordle_lookup_seconds histogram\n" );
+    long cumulative = 0;
+    for ( int i = 0; i < LOOKUP_BUCKETS; i++ ) {
+        cumulative += total( &blocks[ 0 ].lookupBuckets[ i ] );
+        len = appendText( buf, cap, len, "wordle_lookup_seconds_bucket{le=\"%g\"} %ld\n",
+                          (double) lookupBounds[ i ] / NANOS_PER_SECOND, cumulative );
+    }
+    cumulative += total( &blocks[ 0 ].lookupBuckets[ LOOKUP_BUCKETS ] );
+    len = appendText( buf, cap, len, "wordle_lookup_seconds_bucket{le=\"+Inf\"} %ld\n", cumulative );
+    len = appendText( buf, cap, len, "wordle_lookup_seconds_sum %g\nwordle_lookup_seconds_count %ld\n",
+                      (double) total( &blocks[ 0 ].lookupSum ) / NANOS_PER_SECOND, cumulative );
+
+    len = appendText( buf, cap, len, "# HELP wordle_lexicon_words Words in the loaded lexicon.\n"
+                                     "# TYPE wordle_lexicon_words gauge\nwordle_lexicon_words %ld\n",
+                      atomic_load( &lexiconSize ) );
+    len = appendText( buf, cap, len, "# HELP process_resident_memory_bytes Resident memory size in bytes.\n"
+                                     "# TYPE process_resident_memory_bytes gauge\nprocess_resident_memory_bytes %ld\n",
+                      residentBytes() );
+    len = appendText( buf, cap, len, "# HELP process_start_time_seconds Start time of the process since unix epoch.\n"
+                                     "# TYPE process_start_time_seconds gauge\nprocess_start_time_seconds %ld\n",
+                      (long) startTime );
+
+    return len;
+}
+
+/**
+ * Body of the metrics thread. Accepts connections one at a time, reads
+ * the scrape request and answers it with an HTTP response holding the
+ * current metrics, so `curl --unix-socket` and Prometheus proxies work.
+ *
+ * @param arg unused
+ * @return void* unused
+ */
+static void *metricsThread( void *arg )
+{
+    char request[ REQUEST_CAPACITY ];
+    char body[ RESPONSE_CAPACITY ];
+    char header[ REQUEST_CAPACITY ];
+
+    while ( true ) {
+        int fd = accept( listenFd, NULL, NULL );
+        if ( fd < 0 )
+            continue;
+
+        //a scraper that sends nothing or reads nothing must not hold up the next one
+        struct timeval timeout = { SCRAPE_TIMEOUT_SECONDS, 0 };
+        setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof( timeout ) );
+        setsockopt( fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof( timeout ) );
+
+        //the request itself does not matter, every path serves the metrics
+        if ( read( fd, request, sizeof( request ) ) >= 0 ) {
+            int bodyLen = formatMetrics( body, sizeof( body ) );
+            int headerLen = snprintf( header, sizeof( header ),
+                                      "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                      "Content-Length: %d\r\n\r\n", bodyLen );
+            if ( write( fd, header, headerLen ) == headerLen )
+                if ( write( fd, body, bodyLen ) != bodyLen )
+                    fprintf( stderr, "Short write on metrics socket\n" );
+        }
+
+        close( fd );
+    }
+
+    return NULL;
+}
+
+void countMetric( Counter counter )
+{
+    add( &threadBlock()->counters[ counter ], 1 );
+}
+
+void observeLookup( long nanos )
+{
+    ThreadMetrics *block = threadBlock();
+
+    //find the first bucket that holds the observation, or the +Inf bucket
+    int bucket = 0;
+    while ( bucket < LOOKUP_BUCKETS && nanos > lookupBounds[ bucket ] )
+        bucket++;
+
+    add( &block->lookupBuckets[ bucket ], 1 );
+    add( &block->lookupSum, nanos );
+}
+
+void setLexiconSize( long words )
+{
+    atomic_store( &lexiconSize, words );
+}
+
+long monotonicNanos()
+{
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return now.tv_sec * NANOS_PER_SECOND + now.tv_nsec;
+}
+
+bool serveMetrics( char const path[] )
+{
+    struct sockaddr_un addr;
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+
+    //the path has to fit in the socket address with its null terminator
+    if ( strlen( path ) >= sizeof( addr.sun_path ) )
+        return false;
+    strcpy( addr.sun_path, path );
+
+    if ( ( listenFd = socket( AF_UNIX, SOCK_STREAM, 0 ) ) < 0 )
+        return false;
+
+    //remove a stale socket left behind by an earlier run, but never a file
+    //that is something else
+    struct stat info;
+    if ( lstat( path, &info ) == 0 ) {
+        if ( !S_ISSOCK( info.st_mode ) ) {
+            close( listenFd );
+            return false;
+        }
+        unlink( path );
+    }
+    if ( bind( listenFd, (struct sockaddr *) &addr, sizeof( addr ) ) < 0 || listen( listenFd, LISTEN_BACKLOG ) < 0 ) {
+        close( listenFd );
+        return false;
+    }
+
+    startTime = time( NULL );
+
+    //the thread runs for the rest of the process, nobody joins it
+    pthread_t thread;
+    if ( pthread_create( &thread, NULL, metricsThread, NULL ) != 0 ) {
+        close( listenFd );
+        return false;
+    }
+    pthread_detach( thread );
+
+    return true;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file metrics.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-08
+ *
+ * Collects runtime counters and histograms about the game (games played,
+ * guesses made, word look up latency, lexicon size) and serves them in the
+ * Prometheus text exposition format over a local Unix socket.
+ * Every thread counts into its own block of counters, so recording a
+ * metric never takes a lock.
+ *
+ */
+#include <stdbool.h>
+
+/** Maximum number of threads that get their own block of counters */
+#define METRIC_MAX_THREADS 64
+
+/** Number of finite buckets in the word look up latency histogram */
+#define LOOKUP_BUCKETS 8
+
+/** The counters that can be incremented with countMetric */
+typedef enum {
+    METRIC_GAMES_STARTED,
+    METRIC_GAMES_FINISHED,
+    METRIC_GUESSES,
+    METRIC_INVALID_GUESSES,
+    NUM_COUNTERS
+} Counter;
+
+/**
+ * Adds one to the given counter in the calling thread's block of counters.
+ *
+ * @param counter the counter being incremented
+ */
+void countMetric( Counter counter );
+
+/**
+ * Records how long a single word look up took in the latency histogram.
+ *
+ * @param nanos the duration of the look up in nanoseconds
+ */
+void observeLookup( long nanos );
+
+/**
+ * Sets the gauge holding the number of words in the loaded lexicon.
+ *
+ * @param words the number of words in the lexicon
+ */
+void setLexiconSize( long words );
+
+/**
+ * Returns the current time of the monotonic clock in nanoseconds.
+ * Used to time the operations being measured.
+ *
+ * @return long the current monotonic time in nanoseconds
+ */
+long monotonicNanos();
+
+/**
+ * Starts a background thread that listens on a Unix socket at the given
+ * path and answers every connection with the current metrics. A socket
+ * left at the path by an earlier run is replaced, anything else is not.
+ *
+ * @param path the filesystem path of the socket
+ * @return true if the socket was created and the thread started
+ * @return false if else, or if the path holds something other than a socket
+ */
+bool serveMetrics( char const path[] );
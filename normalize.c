@@ -0,0 +1,189 @@
+/**
+ * @file normalize.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-06
+ *
+ * Cleans up word lists that would otherwise be rejected: uppercase letters
+ * are lowercased, and whitespace at the end of each line, carriage returns
+ * included, is dropped. Large buffers are cleaned sixteen bytes at a time
+ * with SSE2 where it is available. What is left is checked as strictly as
+ * any other list.
+ *
+ */
+#include "normalize.h"
+#include "alloc.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/** Number of bytes cleaned at once */
+#define BLOCK 16
+
+/** Difference between an uppercase letter and its lowercase letter */
+#define CASE_BIT 0x20
+
+/** Bytes read from the file at a time */
+#define READ_CHUNK ( 1 << 20 )
+
+/**
+ * Checks if a byte is whitespace that can end a line, other than the line
+ * feed itself.
+ *
+ * @param c the byte
+ * @return true if it is a space, tab, carriage return, vertical tab or form feed
+ * @return false if else
+ */
+static bool isTrailing( char c )
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * Cleans one byte, moving it from the input to the output. Whitespace is
+ * copied in case a letter follows it, and taken back if a line feed does.
+ *
+ * @param c the byte, already lowercased
+ * @param buffer the buffer being cleaned
+ * @param out the number of bytes kept so far, updated
+ * @param pending where the whitespace at the end of the output starts, -1 if none
+ */
+static void cleanByte( char c, char *buffer, long *out, long *pending )
+{
+    if ( isTrailing( c ) ) {
+        if ( *pending < 0 )
+            *pending = *out;
+    } else {
+        if ( c == '\n' && *pending >= 0 )
+            *out = *pending;
+        *pending = -1;
+    }
+    buffer[ ( *out )++ ] = c;
+}
+
+long normalizeBuffer( char *buffer, long size )
+{
+    long in = 0, out = 0, pending = -1;
+
+#ifdef __SSE2__
+    //letters are lowercased a block at a time, and a block without any
+    //whitespace but line feeds is kept whole; the output never gets ahead
+    //of the input, so storing a block only overwrites bytes already read
+    __m128i belowA = _mm_set1_epi8( 'A' - 1 ), aboveZ = _mm_set1_epi8( 'Z' + 1 );
+    __m128i caseBit = _mm_set1_epi8( CASE_BIT ), lowestControl = _mm_set1_epi8( '\t' - 1 );
+    __m128i highestControl = _mm_set1_epi8( '\r' + 1 ), newline = _mm_set1_epi8( '\n' );
+    __m128i space = _mm_set1_epi8( ' ' );
+    for ( ; in + BLOCK <= size; in += BLOCK ) {
+        __m128i bytes = _mm_loadu_si128( (__m128i const *) ( buffer + in ) );
+        __m128i upper = _mm_and_si128( _mm_cmpgt_epi8( bytes, belowA ), _mm_cmplt_epi8( bytes, aboveZ ) );
+        bytes = _mm_add_epi8( bytes, _mm_and_si128( upper, caseBit ) );
+
+        //tab to carriage return, less the line feed, and the space
+        __m128i control = _mm_and_si128( _mm_cmpgt_epi8( bytes, lowestControl ), _mm_cmplt_epi8( bytes, highestControl ) );
+        control = _mm_andnot_si128( _mm_cmpeq_epi8( bytes, newline ), control );
+        __m128i white = _mm_or_si128( control, _mm_cmpeq_epi8( bytes, space ) );
+
+        if ( _mm_movemask_epi8( white ) == 0 ) {
+            if ( pending >= 0 && buffer[ in ] == '\n' )
+                out = pending;
+            pending = -1;
+            _mm_storeu_si128( (__m128i *) ( buffer + out ), bytes );
+            out += BLOCK;
+        } else {
+            char block[ BLOCK ];
+            _mm_storeu_si128( (__m128i *) block, bytes );
+            for ( int i = 0; i < BLOCK; i++ )
+                cleanByte( block[ i ], buffer, &out, &pending );
+        }
+    }
+#endif
+
+    //whatever is left, or everything without SSE2, a byte at a time
+    for ( ; in < size; in++ ) {
+        char c = buffer[ in ];
+        if ( c >= 'A' && c <= 'Z' )
+            c += CASE_BIT;
+        cleanByte( c, buffer, &out, &pending );
+    }
+
+    //whitespace at the very end has no line feed after it
+    return pending >= 0 ? pending : out;
+}
+
+FILE *openNormalized( char const filename[], char **buffer )
+{
+    FILE *fp = fopen( filename, "rb" );
+    if ( fp == NULL )
+        return NULL;
+
+    //read the whole file, growing the buffer as needed
+    long size = 0, capacity = READ_CHUNK;
+    *buffer = countedMalloc( ALLOC_LEXICON, capacity );
+    size_t got;
+    while ( ( got = fread( *buffer + size, 1, capacity - size, fp ) ) > 0 ) {
+        size += got;
+        if ( size == capacity ) {
+            capacity *= 2;
+            *buffer = countedRealloc( ALLOC_LEXICON, *buffer, capacity );
+        }
+    }
+    fclose( fp );
+
+    size = normalizeBuffer( *buffer, size );
+    fp = fmemopen( *buffer, size, "r" );
+    if ( fp == NULL )
+        countedFree( ALLOC_LEXICON, *buffer );
+    return fp;
+}
+
+FILE *openNormalizedCopy( char const filename[] )
+{
+    FILE *in = fopen( filename, "rb" );
+    if ( in == NULL )
+        return NULL;
+    FILE *out = tmpfile();
+    if ( out == NULL ) {
+        fclose( in );
+        return NULL;
+    }
+
+    //only whole lines are cleaned, the start of a line at the end of the
+    //chunk waits for the rest of it; a line longer than a whole chunk can't
+    //be a word, so it is copied as it is for the check to reject
+    char *buffer = countedMalloc( ALLOC_LEXICON, READ_CHUNK );
+    long held = 0;
+    bool written = true;
+    size_t got;
+    while ( written && ( got = fread( buffer + held, 1, READ_CHUNK - held, in ) ) > 0 ) {
+        held += got;
+        long end = held;
+        while ( end > 0 && buffer[ end - 1 ] != '\n' )
+            end--;
+        if ( end == 0 && held < READ_CHUNK )
+            continue;
+
+        long lines = end > 0 ? end : held;
+        long kept = end > 0 ? normalizeBuffer( buffer, lines ) : lines;
+        written = fwrite( buffer, 1, kept, out ) == kept;
+        memmove( buffer, buffer + lines, held - lines );
+        held -= lines;
+    }
+
+    //the last line may have no line feed after it
+    if ( written && held > 0 ) {
+        long kept = normalizeBuffer( buffer, held );
+        written = fwrite( buffer, 1, kept, out ) == kept;
+    }
+
+    countedFree( ALLOC_LEXICON, buffer );
+    fclose( in );
+    if ( !written || fflush( out ) != 0 ) {
+        fclose( out );
+        return NULL;
+    }
+    rewind( out );
+    return out;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file normalize.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-06
+ *
+ * Cleans up word lists that would otherwise be rejected: uppercase letters
+ * are lowercased, and whitespace at the end of each line, carriage returns
+ * included, is dropped. Large buffers are cleaned sixteen bytes at a time
+ * with SSE2 where it is available. What is left is checked as strictly as
+ * any other list.
+ *
+ */
+#include <stdio.h>
+
+/**
+ * Cleans a buffer in place, lowercasing every letter and dropping the
+ * whitespace at the end of every line.
+ *
+ * @param buffer the bytes being cleaned
+ * @param size the number of bytes
+ * @return long the number of bytes left
+ */
+long normalizeBuffer( char *buffer, long size );
+
+/**
+ * Reads a whole file, cleans it with normalizeBuffer and opens the result
+ * for reading. The buffer must be freed with countedFree( ALLOC_LEXICON )
+ * once the returned file has been closed.
+ *
+ * @param filename the file being read
+ * @param buffer where the cleaned contents are stored
+ * @return FILE* the cleaned contents opened for reading, or NULL if the
+ *               file can't be read
+ */
+FILE *openNormalized( char const filename[], char **buffer );
+
+/**
+ * Cleans a file of any size with normalizeBuffer a chunk of whole lines at
+ * a time into a temporary file, and opens the result for reading. Only one
+ * chunk is held in memory at a time.
+ *
+ * @param filename the file being read
+ * @return FILE* the cleaned contents opened for reading, removed when it is
+ *               closed, or NULL if the file can't be read or copied
+ */
+FILE *openNormalizedCopy( char const filename[] );
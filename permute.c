@@ -0,0 +1,84 @@
+/**
+ * @file permute.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-21
+ *
+ * A seeded random permutation of the numbers 0 to size - 1 that can be
+ * evaluated at any position in constant time and memory. It is a Feistel
+ * network over the smallest even power of two that holds size, with
+ * cycle-walking to skip the values that fall outside of it, so no shuffled
+ * array is ever built.
+ *
+ */
+#include "permute.h"
+
+/** Golden ratio increment of the splitmix64 generator */
+#define GOLDEN_GAMMA 0x9e3779b97f4a7c15UL
+
+/**
+ * The splitmix64 finalizer, which scrambles every bit of x into every
+ * bit of the result.
+ *
+ * @param x the value being scrambled
+ * @return unsigned long the scrambled value
+ */
+static unsigned long mix( unsigned long x )
+{
+    x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9UL;
+    x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111ebUL;
+    return x ^ ( x >> 31 );
+}
+
+/**
+ * Runs one pass of the Feistel network. Each round swaps the halves and
+ * mixes a keyed hash of one half into the other, which can always be
+ * undone, so the pass is a permutation of the whole power-of-two domain.
+ *
+ * @param perm the permutation
+ * @param value the value being permuted, less than 4 ^ halfBits
+ * @return unsigned long the permuted value, also less than 4 ^ halfBits
+ */
+static unsigned long feistel( Permutation const *perm, unsigned long value )
+{
+    unsigned long mask = ( 1UL << perm->halfBits ) - 1;
+    unsigned long left = value >> perm->halfBits;
+    unsigned long right = value & mask;
+
+    for ( int r = 0; r < FEISTEL_ROUNDS; r++ ) {
+        unsigned long next = left ^ ( mix( right ^ perm->keys[ r ] ) & mask );
+        left = right;
+        right = next;
+    }
+
+    return ( left << perm->halfBits ) | right;
+}
+
+void initPermutation( Permutation *perm, long size, long seed )
+{
+    perm->size = size;
+
+    //the smallest domain of 4 ^ halfBits values that holds size, so
+    //cycle-walking takes fewer than four steps on average
+    perm->halfBits = 1;
+    while ( ( 1L << ( 2 * perm->halfBits ) ) < size )
+        perm->halfBits++;
+
+    //derive the round keys from the seed the same way splitmix64 does
+    unsigned long state = seed;
+    for ( int r = 0; r < FEISTEL_ROUNDS; r++ ) {
+        state += GOLDEN_GAMMA;
+        perm->keys[ r ] = mix( state );
+    }
+}
+
+long permute( Permutation const *perm, long index )
+{
+    //values outside of 0 to size - 1 are walked forward until they land
+    //inside, which keeps the mapping one-to-one on the smaller range
+    unsigned long value = index;
+    do {
+        value = feistel( perm, value );
+    } while ( value >= (unsigned long) perm->size );
+
+    return value;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file permute.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-21
+ *
+ * A seeded random permutation of the numbers 0 to size - 1 that can be
+ * evaluated at any position in constant time and memory. It is a Feistel
+ * network over the smallest even power of two that holds size, with
+ * cycle-walking to skip the values that fall outside of it, so no shuffled
+ * array is ever built.
+ *
+ */
+
+/** Number of Feistel rounds, enough for the output to look random */
+#define FEISTEL_ROUNDS 4
+
+/** A permutation of the numbers 0 to size - 1 */
+typedef struct {
+    /** The number of values being permuted */
+    long size;
+
+    /** The number of bits in each half of the Feistel network */
+    int halfBits;
+
+    /** The key of each Feistel round, derived from the seed */
+    unsigned long keys[ FEISTEL_ROUNDS ];
+} Permutation;
+
+/**
+ * Sets up the permutation of 0 to size - 1 chosen by seed.
+ *
+ * @param perm the permutation being set up
+ * @param size the number of values, at least 1
+ * @param seed chooses which permutation it is
+ */
+void initPermutation( Permutation *perm, long size, long seed );
+
+/**
+ * Returns the value at the given position of the permutation. Every
+ * position from 0 to size - 1 maps to a different value in that range.
+ *
+ * @param perm the permutation
+ * @param index the position, between 0 and size - 1
+ * @return long the value at that position
+ */
+long permute( Permutation const *perm, long index );
@@ -0,0 +1,473 @@
+/**
+ * @file pool.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-04
+ *
+ * A work-stealing thread pool shared by everything that runs in parallel.
+ * Every worker keeps its own deque of tasks, pushing and popping its own
+ * work at the back while idle workers steal from the front of the others.
+ * Tasks are grouped so a thread can wait for the tasks it forked, helping
+ * to run queued tasks while it waits, and ranges are split recursively
+ * into tasks for parallel loops. The thread driving the pool from outside
+ * takes part as one more worker while it waits.
+ *
+ */
+#define _GNU_SOURCE
+#include "pool.h"
+#include "alloc.h"
+#include "metrics.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+/** Initial number of tasks a deque has room for */
+#define INITIAL_TASKS 64
+
+/** Most times a range is split in half, enough for any count that fits a long */
+#define MAX_SPLITS 64
+
+/** Number of indexes in the benchmark's parallel loop */
+#define BENCH_ITEMS ( 1L << 22 )
+
+/** Indexes per range in the benchmark's parallel loop */
+#define BENCH_GRAIN 4096
+
+/** The benchmark's tree of forked tasks computes this fibonacci number */
+#define BENCH_FIB 27
+
+/** Below this, the fibonacci tree is computed without forking */
+#define FIB_CUTOFF 12
+
+/** A queued task */
+typedef struct {
+    TaskFunction function;
+    void *arg;
+    TaskGroup *group;
+} Task;
+
+/** The tasks of one worker, a ring buffer from head to tail */
+typedef struct {
+    pthread_mutex_t lock;
+    Task *tasks;
+    long capacity;
+    long head;
+    long tail;
+} Deque;
+
+/** A range of a parallel loop */
+typedef struct {
+    RangeFunction body;
+    void *ctx;
+    long start;
+    long end;
+    long grain;
+} Range;
+
+/** One deque per thread of the pool, the last is the driving thread's */
+static Deque *deques;
+static int numThreads;
+
+/** The worker threads, poolSize() - 1 of them or fewer if some failed to start */
+static pthread_t *workers;
+static int numWorkers;
+
+/** Whether the pool is running, and whether it is being stopped */
+static atomic_bool running;
+static atomic_bool stopping;
+
+/** Whether workers are pinned to cores */
+static bool pinned;
+
+/** Number of tasks in all deques, and number of workers asleep waiting for one */
+static atomic_long queued;
+static atomic_int sleeping;
+
+/** Idle workers sleep on wakeUp until a task is queued */
+static pthread_mutex_t sleepLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wakeUp = PTHREAD_COND_INITIALIZER;
+
+/** Guards starting and stopping the pool */
+static pthread_mutex_t startLock = PTHREAD_MUTEX_INITIALIZER;
+
+/** The slot of the calling thread, -1 if it is not a worker */
+static __thread int slot = -1;
+
+/**
+ * Returns the number of online cores, at least 1.
+ *
+ * @return int the number of cores
+ */
+static int numCores()
+{
+    int cores = sysconf( _SC_NPROCESSORS_ONLN );
+    return cores < 1 ? 1 : cores;
+}
+
+/**
+ * Adds a task at the back of a deque, doubling its room if full.
+ *
+ * @param deque the deque
+ * @param task the task
+ */
+static void pushBack( Deque *deque, Task task )
+{
+    pthread_mutex_lock( &deque->lock );
+    if ( deque->tail - deque->head == deque->capacity ) {
+        Task *tasks = countedMalloc( ALLOC_INDEX, deque->capacity * 2 * sizeof( Task ) );
+        for ( long i = deque->head; i < deque->tail; i++ )
+            tasks[ i - deque->head ] = deque->tasks[ i % deque->capacity ];
+        countedFree( ALLOC_INDEX, deque->tasks );
+        deque->tasks = tasks;
+        deque->tail -= deque->head;
+        deque->head = 0;
+        deque->capacity *= 2;
+    }
+    deque->tasks[ deque->tail++ % deque->capacity ] = task;
+    pthread_mutex_unlock( &deque->lock );
+}
+
+/**
+ * Takes a task from the back of a deque, where its owner works. The
+ * newest task is the one most likely to still be in the cache.
+ *
+ * @param deque the deque
+ * @param task where the task is stored
+ * @return true if there was a task
+ * @return false if else
+ */
+static bool popBack( Deque *deque, Task *task )
+{
+    pthread_mutex_lock( &deque->lock );
+    bool found = deque->tail > deque->head;
+    if ( found )
+        *task = deque->tasks[ --deque->tail % deque->capacity ];
+    pthread_mutex_unlock( &deque->lock );
+    return found;
+}
+
+/**
+ * Takes a task from the front of a deque, where thieves work. The oldest
+ * task is usually the biggest piece of work left.
+ *
+ * @param deque the deque
+ * @param task where the task is stored
+ * @return true if there was a task
+ * @return false if else
+ */
+static bool stealFront( Deque *deque, Task *task )
+{
+    pthread_mutex_lock( &deque->lock );
+    bool found = deque->tail > deque->head;
+    if ( found )
+        *task = deque->tasks[ deque->head++ % deque->capacity ];
+    pthread_mutex_unlock( &deque->lock );
+    return found;
+}
+
+/**
+ * Finds a task for a thread: its own newest task, or else the oldest
+ * task of the first other thread that has one.
+ *
+ * @param self the slot of the thread
+ * @param task where the task is stored
+ * @return true if a task was found
+ * @return false if every deque is empty
+ */
+static bool findTask( int self, Task *task )
+{
+    bool found = popBack( &deques[ self ], task );
+    for ( int k = 1; !found && k < numThreads; k++ )
+        found = stealFront( &deques[ ( self + k ) % numThreads ], task );
+    if ( found )
+        atomic_fetch_sub( &queued, 1 );
+    return found;
+}
+
+/**
+ * Runs a task and marks it finished in its group.
+ *
+ * @param task the task
+ */
+static void runTask( Task const *task )
+{
+    task->function( task->arg );
+    atomic_fetch_sub( &task->group->pending, 1 );
+}
+
+/**
+ * Body of a worker thread. Runs tasks while there are any and sleeps
+ * until one is queued otherwise.
+ *
+ * @param arg the slot of the worker
+ * @return void* unused
+ */
+static void *workerThread( void *arg )
+{
+    slot = (int) (intptr_t) arg;
+
+    //a worker that cannot be pinned still works, just unpinned
+    if ( pinned ) {
+        cpu_set_t cores;
+        CPU_ZERO( &cores );
+        CPU_SET( slot % numCores(), &cores );
+        pthread_setaffinity_np( pthread_self(), sizeof( cores ), &cores );
+    }
+
+    while ( !atomic_load( &stopping ) ) {
+        Task task;
+        if ( findTask( slot, &task ) ) {
+            runTask( &task );
+            continue;
+        }
+
+        //count ourselves asleep before checking, so a spawner either sees
+        //us asleep and signals or we see its task
+        pthread_mutex_lock( &sleepLock );
+        atomic_fetch_add( &sleeping, 1 );
+        while ( atomic_load( &queued ) == 0 && !atomic_load( &stopping ) )
+            pthread_cond_wait( &wakeUp, &sleepLock );
+        atomic_fetch_sub( &sleeping, 1 );
+        pthread_mutex_unlock( &sleepLock );
+    }
+    return NULL;
+}
+
+void startPool( int threads, bool pin )
+{
+    //every spawn checks, so a running pool is found without the lock
+    if ( atomic_load( &running ) )
+        return;
+
+    pthread_mutex_lock( &startLock );
+    if ( atomic_load( &running ) ) {
+        pthread_mutex_unlock( &startLock );
+        return;
+    }
+
+    numThreads = threads > 0 ? threads : numCores();
+    if ( numThreads > MAX_POOL_THREADS )
+        numThreads = MAX_POOL_THREADS;
+    pinned = pin;
+    atomic_store( &stopping, false );
+    atomic_store( &queued, 0 );
+
+    deques = countedMalloc( ALLOC_INDEX, numThreads * sizeof( Deque ) );
+    for ( int i = 0; i < numThreads; i++ ) {
+        pthread_mutex_init( &deques[ i ].lock, NULL );
+        deques[ i ].tasks = countedMalloc( ALLOC_INDEX, INITIAL_TASKS * sizeof( Task ) );
+        deques[ i ].capacity = INITIAL_TASKS;
+        deques[ i ].head = deques[ i ].tail = 0;
+    }
+
+    //workers that fail to start leave their deque empty, the rest still steal
+    workers = countedMalloc( ALLOC_INDEX, numThreads * sizeof( pthread_t ) );
+    numWorkers = 0;
+    for ( int i = 0; i < numThreads - 1; i++ )
+        if ( pthread_create( &workers[ numWorkers ], NULL, workerThread, (void *) (intptr_t) i ) == 0 )
+            numWorkers++;
+
+    atomic_store( &running, true );
+    pthread_mutex_unlock( &startLock );
+}
+
+void stopPool()
+{
+    pthread_mutex_lock( &startLock );
+    if ( !atomic_load( &running ) ) {
+        pthread_mutex_unlock( &startLock );
+        return;
+    }
+
+    pthread_mutex_lock( &sleepLock );
+    atomic_store( &stopping, true );
+    pthread_cond_broadcast( &wakeUp );
+    pthread_mutex_unlock( &sleepLock );
+    for ( int i = 0; i < numWorkers; i++ )
+        pthread_join( workers[ i ], NULL );
+
+    for ( int i = 0; i < numThreads; i++ ) {
+        pthread_mutex_destroy( &deques[ i ].lock );
+        countedFree( ALLOC_INDEX, deques[ i ].tasks );
+    }
+    countedFree( ALLOC_INDEX, deques );
+    countedFree( ALLOC_INDEX, workers );
+
+    atomic_store( &running, false );
+    pthread_mutex_unlock( &startLock );
+}
+
+int poolSize()
+{
+    startPool( 0, false );
+    return numThreads;
+}
+
+int poolSlot()
+{
+    return slot < 0 ? numThreads - 1 : slot;
+}
+
+void initTaskGroup( TaskGroup *group )
+{
+    atomic_store( &group->pending, 0 );
+}
+
+void spawnTask( TaskGroup *group, TaskFunction function, void *arg )
+{
+    startPool( 0, false );
+    atomic_fetch_add( &group->pending, 1 );
+    pushBack( &deques[ poolSlot() ], (Task) { function, arg, group } );
+    atomic_fetch_add( &queued, 1 );
+
+    if ( atomic_load( &sleeping ) > 0 ) {
+        pthread_mutex_lock( &sleepLock );
+        pthread_cond_signal( &wakeUp );
+        pthread_mutex_unlock( &sleepLock );
+    }
+}
+
+void joinTasks( TaskGroup *group )
+{
+    //rather than block, run whatever is queued, the group's own tasks first
+    while ( atomic_load( &group->pending ) > 0 ) {
+        Task task;
+        if ( findTask( poolSlot(), &task ) )
+            runTask( &task );
+        else
+            sched_yield();
+    }
+}
+
+/**
+ * Runs a range of a parallel loop. The upper half is forked off again and
+ * again until what is left is small enough to run here, so thieves take
+ * the biggest halves first.
+ *
+ * @param arg the Range
+ */
+static void runRange( void *arg )
+{
+    Range const *range = arg;
+    Range halves[ MAX_SPLITS ];
+    int splits = 0;
+    TaskGroup group;
+    initTaskGroup( &group );
+
+    long start = range->start, end = range->end;
+    while ( end - start > range->grain && splits < MAX_SPLITS ) {
+        long mid = start + ( end - start ) / 2;
+        halves[ splits ] = (Range) { range->body, range->ctx, mid, end, range->grain };
+        spawnTask( &group, runRange, &halves[ splits++ ] );
+        end = mid;
+    }
+
+    range->body( range->ctx, start, end );
+    joinTasks( &group );
+}
+
+void parallelFor( long count, long grain, RangeFunction body, void *ctx )
+{
+    if ( count <= 0 )
+        return;
+
+    startPool( 0, false );
+    Range range = { body, ctx, 0, count, grain < 1 ? 1 : grain };
+    runRange( &range );
+}
+
+/**
+ * Body of the benchmark's parallel loop: a fixed amount of arithmetic per
+ * index, added up so it cannot be optimized away.
+ *
+ * @param ctx the atomic_long the results are added to
+ * @param start the first index
+ * @param end one past the last index
+ */
+static void mixRange( void *ctx, long start, long end )
+{
+    unsigned long sum = 0;
+    for ( long i = start; i < end; i++ ) {
+        unsigned long x = i;
+        for ( int round = 0; round < 32; round++ )
+            x = ( x ^ ( x >> 31 ) ) * 0x9e3779b97f4a7c15UL;
+        sum += x;
+    }
+    atomic_fetch_add( (atomic_long *) ctx, (long) sum );
+}
+
+/** A fibonacci number computed by a tree of forked tasks */
+typedef struct {
+    int n;
+    long result;
+} Fib;
+
+/**
+ * Computes a fibonacci number the slow recursive way, without forking.
+ *
+ * @param n which fibonacci number
+ * @return long the number
+ */
+static long fibonacci( int n )
+{
+    return n < 2 ? n : fibonacci( n - 1 ) + fibonacci( n - 2 );
+}
+
+/**
+ * Computes a fibonacci number, forking one of the two halves.
+ *
+ * @param arg the Fib
+ */
+static void fibTask( void *arg )
+{
+    Fib *fib = arg;
+    if ( fib->n < FIB_CUTOFF ) {
+        fib->result = fibonacci( fib->n );
+        return;
+    }
+
+    Fib left = { fib->n - 1, 0 }, right = { fib->n - 2, 0 };
+    TaskGroup group;
+    initTaskGroup( &group );
+    spawnTask( &group, fibTask, &left );
+    fibTask( &right );
+    joinTasks( &group );
+    fib->result = left.result + right.result;
+}
+
+void benchmarkPool( FILE *out, bool pin )
+{
+    int cores = numCores();
+    stopPool();
+
+    fprintf( out, "%7s  %10s  %8s  %12s  %8s\n", "threads", "loop ms", "speedup", "fork/join ms", "speedup" );
+    double loopBase = 0, forkBase = 0;
+    //double the threads each time, ending with exactly one per core
+    for ( int threads = 1;; threads *= 2 ) {
+        if ( threads > cores )
+            threads = cores;
+        startPool( threads, pin );
+
+        atomic_long sink = 0;
+        long start = monotonicNanos();
+        parallelFor( BENCH_ITEMS, BENCH_GRAIN, mixRange, &sink );
+        double loopMs = ( monotonicNanos() - start ) / 1e6;
+
+        Fib fib = { BENCH_FIB, 0 };
+        start = monotonicNanos();
+        fibTask( &fib );
+        double forkMs = ( monotonicNanos() - start ) / 1e6;
+
+        stopPool();
+
+        if ( threads == 1 ) {
+            loopBase = loopMs;
+            forkBase = forkMs;
+        }
+        fprintf( out, "%7d  %10.2f  %7.2fx  %12.2f  %7.2fx\n", threads, loopMs, loopBase / loopMs, forkMs, forkBase / forkMs );
+        if ( threads == cores )
+            break;
+    }
+}
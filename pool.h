@@ -0,0 +1,109 @@
+/**
+ * @file pool.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-04
+ *
+ * A work-stealing thread pool shared by everything that runs in parallel.
+ * Every worker keeps its own deque of tasks, pushing and popping its own
+ * work at the back while idle workers steal from the front of the others.
+ * Tasks are grouped so a thread can wait for the tasks it forked, helping
+ * to run queued tasks while it waits, and ranges are split recursively
+ * into tasks for parallel loops. The thread driving the pool from outside
+ * takes part as one more worker while it waits.
+ *
+ */
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+/** Most threads the pool can be asked to run with */
+#define MAX_POOL_THREADS 256
+
+/** A task: a function and the argument it is called with */
+typedef void (*TaskFunction)( void *arg );
+
+/** The body of a parallel loop, run on indexes start to end - 1 */
+typedef void (*RangeFunction)( void *ctx, long start, long end );
+
+/** Tasks forked together and waited for together */
+typedef struct {
+    /** Number of tasks of the group not yet finished */
+    atomic_long pending;
+} TaskGroup;
+
+/**
+ * Starts the pool. Does nothing if it is already running; the pool also
+ * starts itself with the defaults the first time it is used.
+ *
+ * @param threads the number of threads working, counting the thread
+ *                driving the pool, or 0 for one per core
+ * @param pin whether every worker is pinned to its own core
+ */
+void startPool( int threads, bool pin );
+
+/**
+ * Stops the pool, waiting for its workers to exit. Every task group must
+ * have been joined.
+ */
+void stopPool();
+
+/**
+ * Returns the number of threads working in the pool, counting the thread
+ * driving it. Slots of per-thread data are indexed by poolSlot.
+ *
+ * @return int the number of threads
+ */
+int poolSize();
+
+/**
+ * Returns the slot of the calling thread: 0 to poolSize() - 2 for the
+ * workers, poolSize() - 1 for the thread driving the pool.
+ *
+ * @return int the slot of the calling thread
+ */
+int poolSlot();
+
+/**
+ * Starts a group of tasks with no tasks in it.
+ *
+ * @param group the group
+ */
+void initTaskGroup( TaskGroup *group );
+
+/**
+ * Forks a task onto the calling thread's deque, where it may be stolen.
+ *
+ * @param group the group the task belongs to
+ * @param function the task
+ * @param arg the argument it is called with, which must outlive the task
+ */
+void spawnTask( TaskGroup *group, TaskFunction function, void *arg );
+
+/**
+ * Waits for every task of a group to finish, running queued tasks
+ * meanwhile.
+ *
+ * @param group the group
+ */
+void joinTasks( TaskGroup *group );
+
+/**
+ * Runs body on every index from 0 to count - 1, split into ranges of at
+ * most grain indexes that run in parallel, and returns once all are done.
+ *
+ * @param count the number of indexes
+ * @param grain the most indexes in one range, at least 1
+ * @param body the loop body
+ * @param ctx the context passed to body
+ */
+void parallelFor( long count, long grain, RangeFunction body, void *ctx );
+
+/**
+ * Measures how the pool scales: the time of a parallel loop and of a
+ * tree of forked tasks with 1, 2, 4, ... threads up to the number of
+ * cores, and the speedup over one thread.
+ *
+ * @param out the file the results are printed to
+ * @param pin whether workers are pinned to cores
+ */
+void benchmarkPool( FILE *out, bool pin );
@@ -0,0 +1,247 @@
+/**
+ * @file rank.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-14
+ *
+ * Ranks every word in the lexicon as an opening guess. Each word is
+ * played against every possible target and scored by how well its
+ * feedback splits the targets up: the expected number of candidates
+ * left, the entropy of the feedback, and the size of the largest group
+ * of targets that share one feedback. In hard mode the second guess must
+ * be one of the targets left, so each word is also scored by the number
+ * of targets left after the best such second guess.
+ *
+ */
+#include "rank.h"
+#include "lexicon.h"
+#include "feedback.h"
+#include "alloc.h"
+#include "pool.h"
+#include "fbindex.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+
+/** The scores of one opening guess */
+typedef struct {
+    /** Index of the guess in the lexicon */
+    int index;
+
+    /** Expected number of targets left after the feedback */
+    double expected;
+
+    /** Entropy of the feedback in bits */
+    double entropy;
+
+    /** Number of targets in the largest feedback group */
+    int worst;
+
+    /** Expected number of targets left after the best hard mode second guess, in hard mode */
+    double second;
+} OpenerScore;
+
+/** Guesses scored per task of the parallel loop */
+#define RANK_GRAIN 16
+
+/** The work shared by every ranking task */
+typedef struct {
+    /** Every word, WORD_LEN letters each, back to back and without terminators */
+    char const *letters;
+
+    /** Number of words */
+    int n;
+
+    /** Where the scores are written, one per guess */
+    OpenerScore *scores;
+
+    /** Whether the second guess must be one of the targets left */
+    bool hard;
+} RankJob;
+
+/**
+ * Scores one guess against every target.
+ *
+ * @param letters every word back to back
+ * @param n the number of words
+ * @param guess the index of the guess being scored
+ * @param score where the score is written
+ */
+static void scoreOpener( char const *letters, int n, int guess, OpenerScore *score )
+{
+    //count how many targets land in each feedback group
+    int groups[ NUM_FEEDBACK_CODES ] = { 0 };
+    char const *guessLetters = letters + (long) guess * WORD_LEN;
+    for ( int target = 0; target < n; target++ )
+        groups[ feedbackCode( guessLetters, letters + (long) target * WORD_LEN ) ]++;
+
+    //a target in a group of size c leaves c candidates, so the expected
+    //number left is the sum of c * c / n over all groups
+    long sumSquares = 0;
+    double entropy = 0;
+    int worst = 0;
+    for ( int code = 0; code < NUM_FEEDBACK_CODES; code++ ) {
+        int c = groups[ code ];
+        if ( c == 0 )
+            continue;
+
+        double p = (double) c / n;
+        sumSquares += (long) c * c;
+        entropy -= p * log2( p );
+        if ( c > worst )
+            worst = c;
+    }
+
+    score->index = guess;
+    score->expected = (double) sumSquares / n;
+    score->entropy = entropy;
+    score->worst = worst;
+}
+
+/**
+ * Scores the second guess of hard mode after an opener: within each
+ * group of targets the opener's feedback leaves, the target that splits
+ * the group best is guessed next, and the sizes of the groups that leaves
+ * are what the score adds up. Uses the feedback index.
+ *
+ * @param n the number of words
+ * @param guess the index of the opener
+ * @param groups scratch room for one count per feedback code, all zero,
+ *               and left all zero
+ * @param codes scratch room for one feedback code per word
+ * @param score where the score is written
+ */
+static void scoreHardSecond( int n, int guess, int groups[], int codes[], OpenerScore *score )
+{
+    long left = 0;
+    for ( int code = 0; code < feedbackCodes(); code++ ) {
+        int const *group;
+        int size = postingList( guess, code, &group );
+
+        //with two targets or fewer, either one leaves only itself and the other
+        if ( size <= 2 ) {
+            left += size;
+            continue;
+        }
+
+        //a target in a group of size k leaves k, so the sum of k * k over
+        //the groups of the second guess is what is minimized; nothing beats
+        //splitting the group into groups of one
+        long best = LONG_MAX;
+        for ( int g = 0; g < size && best > size; g++ ) {
+            for ( int t = 0; t < size; t++ ) {
+                codes[ t ] = indexedFeedback( group[ g ], group[ t ] );
+                groups[ codes[ t ] ]++;
+            }
+
+            //clearing each group as it is counted leaves the scratch all zero
+            long sumSquares = 0;
+            for ( int t = 0; t < size; t++ ) {
+                sumSquares += (long) groups[ codes[ t ] ] * groups[ codes[ t ] ];
+                groups[ codes[ t ] ] = 0;
+            }
+            if ( sumSquares < best )
+                best = sumSquares;
+        }
+        left += best;
+    }
+
+    score->second = (double) left / n;
+}
+
+/**
+ * Body of the ranking loop, scoring one range of guesses.
+ *
+ * @param ctx the RankJob
+ * @param start the first guess
+ * @param end one past the last guess
+ */
+static void rankRange( void *ctx, long start, long end )
+{
+    RankJob const *job = ctx;
+    int *groups = NULL, *codes = NULL;
+    if ( job->hard ) {
+        groups = countedMalloc( ALLOC_SESSION, feedbackCodes() * sizeof( int ) );
+        memset( groups, 0, feedbackCodes() * sizeof( int ) );
+        codes = countedMalloc( ALLOC_SESSION, job->n * sizeof( int ) );
+    }
+
+    for ( long guess = start; guess < end; guess++ ) {
+        scoreOpener( job->letters, job->n, guess, &job->scores[ guess ] );
+        job->scores[ guess ].second = 0;
+        if ( job->hard )
+            scoreHardSecond( job->n, guess, groups, codes, &job->scores[ guess ] );
+    }
+
+    if ( job->hard ) {
+        countedFree( ALLOC_SESSION, codes );
+        countedFree( ALLOC_SESSION, groups );
+    }
+}
+
+/**
+ * Orders scores from best to worst: fewest expected candidates left after
+ * a hard mode second guess, then fewest expected candidates left, then
+ * highest entropy, then alphabetically. Outside hard mode every second
+ * score is 0.
+ *
+ * @param a the first score
+ * @param b the second score
+ * @return int negative, zero or positive like strcmp
+ */
+static int compareScores( void const *a, void const *b )
+{
+    OpenerScore const *x = a, *y = b;
+    if ( x->second != y->second )
+        return x->second < y->second ? -1 : 1;
+    if ( x->expected != y->expected )
+        return x->expected < y->expected ? -1 : 1;
+    if ( x->entropy != y->entropy )
+        return x->entropy > y->entropy ? -1 : 1;
+    return x->index - y->index;
+}
+
+bool rankOpeners( FILE *out, bool hard )
+{
+    int n = lexiconSize();
+    if ( n == 0 ) {
+        fprintf( out, "The word list has no words\n" );
+        return true;
+    }
+
+    //hard mode looks the second guesses up in the feedback index
+    if ( hard && !buildFeedbackIndex() )
+        return false;
+
+    //copy the words into one tight array so the inner loop streams through memory
+    char *letters = countedMalloc( ALLOC_INDEX, (size_t) n * WORD_LEN );
+    for ( int i = 0; i < n; i++ )
+        memcpy( letters + (long) i * WORD_LEN, lexiconWord( i ), WORD_LEN );
+
+    OpenerScore *scores = countedMalloc( ALLOC_INDEX, n * sizeof( OpenerScore ) );
+
+    //the pool splits the guesses up, idle workers steal what is left
+    RankJob job = { letters, n, scores, hard };
+    parallelFor( n, RANK_GRAIN, rankRange, &job );
+
+    qsort( scores, n, sizeof( OpenerScore ), compareScores );
+
+    fprintf( out, "%6s  %-*s  %10s  %8s  %6s", "rank", WORD_LEN, "word", "expected", "entropy", "worst" );
+    if ( hard )
+        fprintf( out, "  %10s", "hard next" );
+    fprintf( out, "\n" );
+    for ( int i = 0; i < n; i++ ) {
+        fprintf( out, "%6d  %-*s  %10.3f  %8.4f  %6d", i + 1, WORD_LEN, lexiconWord( scores[ i ].index ),
+                 scores[ i ].expected, scores[ i ].entropy, scores[ i ].worst );
+        if ( hard )
+            fprintf( out, "  %10.3f", scores[ i ].second );
+        fprintf( out, "\n" );
+    }
+
+    countedFree( ALLOC_INDEX, scores );
+    countedFree( ALLOC_INDEX, letters );
+    if ( hard )
+        freeFeedbackIndex();
+    return true;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file rank.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-14
+ *
+ * Ranks every word in the lexicon as an opening guess. Each word is
+ * played against every possible target and scored by how well its
+ * feedback splits the targets up: the expected number of candidates
+ * left, the entropy of the feedback, and the size of the largest group
+ * of targets that share one feedback. In hard mode the second guess must
+ * be one of the targets left, so each word is also scored by the number
+ * of targets left after the best such second guess.
+ *
+ */
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * Scores every word in the sorted lexicon as an opening guess against
+ * every word as a target, spread across all available cores, and prints
+ * the words from best to worst expected number of remaining candidates.
+ * In hard mode they are ranked by the candidates left after the best
+ * second guess among the candidates instead.
+ *
+ * @param out the file the table is printed to
+ * @param hard whether the second guess must be one of the candidates left
+ * @return true if the words were ranked, or there were none to rank
+ * @return false if the list is too long to index for hard mode
+ */
+bool rankOpeners( FILE *out, bool hard );
@@ -0,0 +1,210 @@
+/**
+ * @file registry.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-30
+ *
+ * Keeps every loaded lexicon in one place so games that use the same word
+ * list share one copy of it. Lexicons are counted by the number of games
+ * holding them and unloaded when the last one lets go, and two files with
+ * the same words share one lexicon, found by the fingerprint of their
+ * contents and then compared word by word. Lexicons are sorted as they
+ * load and never change afterwards, so each game views one through its
+ * own Session. Safe to use from several threads.
+ *
+ */
+#include "registry.h"
+#include "lexicon.h"
+#include "alloc.h"
+
+#include <string.h>
+#include <pthread.h>
+
+/** Initial capacity of the registry's tables */
+#define INITIAL_ENTRIES 4
+
+/** A loaded lexicon and the number of games holding it */
+typedef struct {
+    Lexicon *lexicon;
+    int refs;
+} Loaded;
+
+/** A file name that has been loaded, how, and the lexicon it turned out to be */
+typedef struct {
+    char *filename;
+    bool mixed;
+    bool lenient;
+    Lexicon *lexicon;
+} Alias;
+
+/** Every loaded lexicon */
+static Loaded *loaded;
+static int numLoaded;
+static int loadedCapacity;
+
+/** Every file name that maps to a loaded lexicon */
+static Alias *aliases;
+static int numAliases;
+static int aliasCapacity;
+
+/** Guards every table of the registry */
+static pthread_mutex_t registryLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Makes room for one more entry in a table, doubling its capacity if full.
+ *
+ * @param table the table
+ * @param count the number of entries in it
+ * @param capacity its capacity, updated if it grows
+ * @param size the size of one entry
+ * @return void* the table, which may have moved
+ */
+static void *reserve( void *table, int count, int *capacity, size_t size )
+{
+    if ( count < *capacity )
+        return table;
+
+    *capacity = *capacity == 0 ? INITIAL_ENTRIES : *capacity * 2;
+    return countedRealloc( ALLOC_LEXICON, table, *capacity * size );
+}
+
+/**
+ * Finds the entry of a loaded lexicon.
+ *
+ * @param lexicon the lexicon
+ * @return Loaded* its entry, or NULL if it is not loaded
+ */
+static Loaded *findLoaded( Lexicon const *lexicon )
+{
+    for ( int i = 0; i < numLoaded; i++ )
+        if ( loaded[ i ].lexicon == lexicon )
+            return &loaded[ i ];
+    return NULL;
+}
+
+/**
+ * Takes one more hold on the lexicon a file name was loaded as before, if
+ * it was loaded the same way. The caller holds registryLock.
+ *
+ * @param filename the word list file
+ * @param mixed whether words of other lengths than WORD_LEN are allowed
+ * @param lenient whether the list is cleaned up before it is checked
+ * @return Lexicon* the lexicon now held, or NULL if the file was not loaded that way
+ */
+static Lexicon *holdAlias( char const filename[], bool mixed, bool lenient )
+{
+    for ( int i = 0; i < numAliases; i++ ) {
+        if ( aliases[ i ].mixed == mixed && aliases[ i ].lenient == lenient && strcmp( aliases[ i ].filename, filename ) == 0 ) {
+            findLoaded( aliases[ i ].lexicon )->refs++;
+            return aliases[ i ].lexicon;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Lets go of one hold on a lexicon, unloading it and forgetting every file
+ * name that led to it once no game holds it. The caller holds registryLock.
+ *
+ * @param lexicon the lexicon being let go of
+ */
+static void dropHold( Lexicon *lexicon )
+{
+    Loaded *entry = findLoaded( lexicon );
+    if ( entry == NULL || --entry->refs > 0 )
+        return;
+
+    //forget every file name that led to it, keeping the others in order
+    int kept = 0;
+    for ( int i = 0; i < numAliases; i++ ) {
+        if ( aliases[ i ].lexicon == lexicon )
+            countedFree( ALLOC_LEXICON, aliases[ i ].filename );
+        else
+            aliases[ kept++ ] = aliases[ i ];
+    }
+    numAliases = kept;
+
+    //the last entry fills the gap
+    *entry = loaded[ --numLoaded ];
+    freeLexicon( lexicon );
+}
+
+Lexicon *acquireLexicon( char const filename[], bool mixed )
+{
+    bool lenient = isLenient();
+
+    //a file that has been loaded the same way before is shared without reading it again
+    pthread_mutex_lock( &registryLock );
+    Lexicon *lexicon = holdAlias( filename, mixed, lenient );
+    pthread_mutex_unlock( &registryLock );
+    if ( lexicon != NULL )
+        return lexicon;
+
+    //reading the file is slow, so other games are not kept waiting for it
+    Lexicon *fresh = loadLexicon( filename, mixed );
+
+    //a new file may still hold the same words as a loaded one, those with the
+    //same fingerprint are held so none is unloaded while they are compared
+    pthread_mutex_lock( &registryLock );
+    Lexicon **held = countedMalloc( ALLOC_LEXICON, ( numLoaded + 1 ) * sizeof( Lexicon * ) );
+    int numHeld = 0;
+    for ( int i = 0; i < numLoaded; i++ ) {
+        if ( lexiconFingerprint( loaded[ i ].lexicon ) == lexiconFingerprint( fresh ) ) {
+            loaded[ i ].refs++;
+            held[ numHeld++ ] = loaded[ i ].lexicon;
+        }
+    }
+    pthread_mutex_unlock( &registryLock );
+
+    Lexicon *same = NULL;
+    for ( int i = 0; i < numHeld && same == NULL; i++ )
+        if ( sameWords( held[ i ], fresh ) )
+            same = held[ i ];
+
+    pthread_mutex_lock( &registryLock );
+
+    //the hold on the lexicon with the same words becomes the caller's
+    for ( int i = 0; i < numHeld; i++ )
+        if ( held[ i ] != same )
+            dropHold( held[ i ] );
+
+    //another game may have loaded the same file while this one was reading it
+    lexicon = holdAlias( filename, mixed, lenient );
+    if ( lexicon != NULL ) {
+        if ( same != NULL )
+            dropHold( same );
+    } else {
+        if ( same == NULL ) {
+            loaded = reserve( loaded, numLoaded, &loadedCapacity, sizeof( Loaded ) );
+            loaded[ numLoaded++ ] = (Loaded) { fresh, 1 };
+            same = fresh;
+        }
+
+        //remember the file name so the next game using it skips the load
+        aliases = reserve( aliases, numAliases, &aliasCapacity, sizeof( Alias ) );
+        char *name = countedMalloc( ALLOC_LEXICON, strlen( filename ) + 1 );
+        strcpy( name, filename );
+        aliases[ numAliases++ ] = (Alias) { name, mixed, lenient, same };
+        lexicon = same;
+    }
+
+    pthread_mutex_unlock( &registryLock );
+    countedFree( ALLOC_LEXICON, held );
+    if ( lexicon != fresh )
+        freeLexicon( fresh );
+    return lexicon;
+}
+
+void releaseLexicon( Lexicon *lexicon )
+{
+    pthread_mutex_lock( &registryLock );
+    dropHold( lexicon );
+    pthread_mutex_unlock( &registryLock );
+}
+
+int loadedLexicons()
+{
+    pthread_mutex_lock( &registryLock );
+    int count = numLoaded;
+    pthread_mutex_unlock( &registryLock );
+    return count;
+}
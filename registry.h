@@ -0,0 +1,43 @@
+/**
+ * @file registry.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-30
+ *
+ * Keeps every loaded lexicon in one place so games that use the same word
+ * list share one copy of it. Lexicons are counted by the number of games
+ * holding them and unloaded when the last one lets go, and two files with
+ * the same words share one lexicon, found by the fingerprint of their
+ * contents and then compared word by word. Lexicons are sorted as they
+ * load and never change afterwards, so each game views one through its
+ * own Session. Safe to use from several threads.
+ *
+ */
+#include <stdbool.h>
+
+/**
+ * Returns the lexicon of the given word list file, loading it only if no
+ * game holds it or a list with the same contents. A file is only shared
+ * with games that loaded it the same way, mixed and lenient alike. The
+ * file is read and compared without holding up other threads. Every
+ * acquire must be matched by a release.
+ *
+ * @param filename the word list file
+ * @param mixed whether words of other lengths than WORD_LEN are allowed
+ * @return struct Lexicon* the shared lexicon
+ */
+struct Lexicon *acquireLexicon( char const filename[], bool mixed );
+
+/**
+ * Lets go of a lexicon from acquireLexicon, unloading it once no game
+ * holds it any longer.
+ *
+ * @param lexicon the lexicon being let go of
+ */
+void releaseLexicon( struct Lexicon *lexicon );
+
+/**
+ * Returns the number of different lexicons currently loaded.
+ *
+ * @return int the number of loaded lexicons
+ */
+int loadedLexicons();
@@ -0,0 +1,80 @@
+/**
+ * @file registrycheck.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-30
+ *
+ * Checks that the registry shares one lexicon among every game using the
+ * same words, whether they name the same file or a copy of it, and that
+ * the lexicon is unloaded when the last game lets go of it. Run by make
+ * check with a word list and a copy of it under another name.
+ *
+ */
+#define TRACE_DEFINE_SEMAPHORES
+#include "trace.h"
+#include "registry.h"
+#include "lexicon.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/** The number of expectations that did not hold */
+static int failures;
+
+/**
+ * Reports an expectation that did not hold.
+ *
+ * @param holds whether the expectation holds
+ * @param what what was expected
+ */
+static void expect( bool holds, char const what[] )
+{
+    if ( !holds ) {
+        fprintf( stderr, "registry check failed: %s\n", what );
+        failures++;
+    }
+}
+
+/**
+ * Acquires a word list under both of its names, strictly and leniently,
+ * then releases it down to no holder.
+ *
+ * @param argc the number of cmnd-line arguments
+ * @param argv the word list and a copy of it under another name
+ * @return int exit status
+ */
+int main( int argc, char *argv[] )
+{
+    if ( argc != 3 ) {
+        fprintf( stderr, "usage: registrycheck <word-list-file> <copy-of-it>\n" );
+        return EXIT_FAILURE;
+    }
+
+    Lexicon *first = acquireLexicon( argv[ 1 ], false );
+    Lexicon *again = acquireLexicon( argv[ 1 ], false );
+    Lexicon *copy = acquireLexicon( argv[ 2 ], false );
+    setLenient( true );
+    Lexicon *cleaned = acquireLexicon( argv[ 1 ], false );
+    setLenient( false );
+
+    expect( again == first, "the same file was loaded twice" );
+    expect( copy == first, "a copy of a loaded file was not shared" );
+    expect( cleaned == first, "a lenient load of clean words was not shared" );
+    expect( loadedLexicons() == 1, "one list is not one lexicon" );
+
+    releaseLexicon( cleaned );
+    releaseLexicon( copy );
+    releaseLexicon( again );
+    expect( loadedLexicons() == 1, "a lexicon was unloaded while still held" );
+    releaseLexicon( first );
+    expect( loadedLexicons() == 0, "a lexicon stayed loaded after its last release" );
+
+    //every name was forgotten with it, so the file is read again
+    Lexicon *reloaded = acquireLexicon( argv[ 2 ], false );
+    expect( loadedLexicons() == 1, "a released list could not be loaded again" );
+    releaseLexicon( reloaded );
+    expect( loadedLexicons() == 0, "a reloaded lexicon stayed loaded" );
+
+    if ( failures == 0 )
+        fprintf( stdout, "registry check passed\n" );
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
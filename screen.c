@@ -0,0 +1,303 @@
+/**
+ * @file screen.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-16
+ *
+ * Full-screen view of a game: the board of guesses, the letters of the
+ * keyboard in the best color each has earned, and two lines of messages,
+ * with the guess typed on the line below them. What is shown is drawn into
+ * a back buffer, and a refresh compares it with what the terminal already
+ * shows and only sends the cells that changed, with as few cursor moves
+ * and color changes as it can, so a guess costs a few dozen bytes.
+ *
+ */
+#include "screen.h"
+#include "feedback.h"
+#include "io.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Number of guesses the board shows, the most recent ones */
+#define BOARD_ROWS 6
+
+/** First line of the keyboard, after a blank line below the board */
+#define KEYBOARD_TOP ( BOARD_ROWS + 1 )
+
+/** Number of lines of the keyboard */
+#define KEYBOARD_ROWS 3
+
+/** First line of messages, after a blank line below the keyboard */
+#define STATUS_TOP ( KEYBOARD_TOP + KEYBOARD_ROWS + 1 )
+
+/** Number of lines the view is made of */
+#define SCREEN_ROWS ( STATUS_TOP + 2 )
+
+/** Number of columns the view is made of */
+#define SCREEN_COLS 48
+
+/** Line the guess is typed on, below the view */
+#define INPUT_ROW SCREEN_ROWS
+
+/** Most bytes a refresh can send: a cursor move, a color and a letter per cell */
+#define FRAME_CAPACITY ( SCREEN_ROWS * SCREEN_COLS * 16 )
+
+/** Number of letters in the alphabet */
+#define NUM_LETTERS 26
+
+/** Colors of cells, in the order a keyboard letter earns them */
+typedef enum { COLOR_DEFAULT, COLOR_ABSENT, COLOR_YELLOW, COLOR_GREEN, NUM_SCREEN_COLORS } ScreenColor;
+
+/** The escape sequence switching to each color */
+static char const *colorCodes[ NUM_SCREEN_COLORS ] = { "\x1b[0m", "\x1b[90m", "\x1b[33m", "\x1b[32m" };
+
+/** The letters of each line of the keyboard, and how far each line is indented */
+static char const *keyboardRows[ KEYBOARD_ROWS ] = { "qwertyuiop", "asdfghjkl", "zxcvbnm" };
+static int const keyboardIndent[ KEYBOARD_ROWS ] = { 0, 1, 3 };
+
+/** One character of the view */
+typedef struct {
+    char ch;
+    unsigned char color;
+} Cell;
+
+/** What the view should show, and what the terminal shows */
+static Cell back[ SCREEN_ROWS ][ SCREEN_COLS ];
+static Cell front[ SCREEN_ROWS ][ SCREEN_COLS ];
+
+/** The best color each letter of the keyboard has earned */
+static unsigned char letterColors[ NUM_LETTERS ];
+
+/** Number of guesses on the board */
+static int boardRows;
+
+/** Where the terminal's cursor is, -1 if unknown, and the color it prints in */
+static int cursorRow;
+static int cursorCol;
+static int cursorColor;
+
+/** The escape sequences of a refresh, collected so they are sent at once */
+static char frame[ FRAME_CAPACITY ];
+static int frameLen;
+
+/** Whether the view is on the terminal */
+static bool started;
+
+/**
+ * Adds text to the frame being collected.
+ *
+ * @param text the text
+ */
+static void emit( char const text[] )
+{
+    int len = strlen( text );
+    memcpy( frame + frameLen, text, len );
+    frameLen += len;
+}
+
+/**
+ * Sends the collected frame to the terminal and starts a new one.
+ */
+static void sendFrame()
+{
+    fwrite( frame, 1, frameLen, stdout );
+    fflush( stdout );
+    frameLen = 0;
+}
+
+/**
+ * Switches the color the terminal prints in, if it differs.
+ *
+ * @param color the color
+ */
+static void setColor( int color )
+{
+    if ( color != cursorColor ) {
+        emit( colorCodes[ color ] );
+        cursorColor = color;
+    }
+}
+
+/**
+ * Moves the terminal's cursor to a cell the cheapest way: not at all, by
+ * printing the few cells in between again when they are in the current
+ * color, forward along the line, or to the cell's line and column.
+ *
+ * @param row the line of the cell
+ * @param col the column of the cell
+ */
+static void moveTo( int row, int col )
+{
+    if ( row == cursorRow && col == cursorCol )
+        return;
+
+    char move[ 16 ];
+    if ( row == cursorRow && col > cursorCol ) {
+        snprintf( move, sizeof( move ), "\x1b[%dC", col - cursorCol );
+
+        //the cells in between are unchanged, so printing them again is free
+        //to look at and cheaper than a move if there are few of them
+        bool reprint = col - cursorCol <= strlen( move );
+        for ( int c = cursorCol; c < col && reprint; c++ )
+            reprint = front[ row ][ c ].color == cursorColor || front[ row ][ c ].ch == ' ';
+        if ( reprint )
+            for ( int c = cursorCol; c < col; c++ )
+                frame[ frameLen++ ] = front[ row ][ c ].ch;
+        else
+            emit( move );
+    } else {
+        snprintf( move, sizeof( move ), "\x1b[%d;%dH", row + 1, col + 1 );
+        emit( move );
+    }
+
+    cursorRow = row;
+    cursorCol = col;
+}
+
+/**
+ * Checks whether a cell of the back buffer differs from the terminal's.
+ * Blanks look the same in every color.
+ *
+ * @param row the line of the cell
+ * @param col the column of the cell
+ * @return true if the cell has to be sent
+ * @return false if else
+ */
+static bool changed( int row, int col )
+{
+    Cell want = back[ row ][ col ];
+    Cell shown = front[ row ][ col ];
+    return want.ch != shown.ch || ( want.color != shown.color && want.ch != ' ' );
+}
+
+/**
+ * Writes text into a line of the back buffer in one color, blanking the
+ * rest of the line.
+ *
+ * @param row the line
+ * @param text the text, cut off at the width of the view
+ */
+static void drawLine( int row, char const text[] )
+{
+    int col = 0;
+    for ( ; text[ col ] && col < SCREEN_COLS; col++ )
+        back[ row ][ col ] = (Cell) { text[ col ], COLOR_DEFAULT };
+    for ( ; col < SCREEN_COLS; col++ )
+        back[ row ][ col ] = (Cell) { ' ', COLOR_DEFAULT };
+}
+
+/**
+ * Draws the keyboard into the back buffer, each letter in its color.
+ */
+static void drawKeyboard()
+{
+    for ( int r = 0; r < KEYBOARD_ROWS; r++ ) {
+        drawLine( KEYBOARD_TOP + r, "" );
+        for ( int k = 0; keyboardRows[ r ][ k ]; k++ ) {
+            char letter = keyboardRows[ r ][ k ];
+            back[ KEYBOARD_TOP + r ][ keyboardIndent[ r ] + k * 2 ] = (Cell) { letter, letterColors[ letter - LOWERCASE_A ] };
+        }
+    }
+}
+
+void startScreen()
+{
+    for ( int r = 0; r < SCREEN_ROWS; r++ ) {
+        drawLine( r, "" );
+        memcpy( front[ r ], back[ r ], sizeof( front[ r ] ) );
+    }
+    memset( letterColors, COLOR_DEFAULT, sizeof( letterColors ) );
+    drawKeyboard();
+    boardRows = 0;
+
+    //the terminal starts out cleared, in the default color
+    emit( "\x1b[H\x1b[2J" );
+    emit( colorCodes[ COLOR_DEFAULT ] );
+    cursorRow = 0;
+    cursorCol = 0;
+    cursorColor = COLOR_DEFAULT;
+
+    if ( !started )
+        atexit( endScreen );
+    started = true;
+}
+
+void screenGuess( char const guess[], int code )
+{
+    //a full board scrolls up to make room
+    if ( boardRows == BOARD_ROWS ) {
+        memmove( back[ 0 ], back[ 1 ], ( BOARD_ROWS - 1 ) * sizeof( back[ 0 ] ) );
+        boardRows--;
+    }
+
+    int row = boardRows++;
+    drawLine( row, "" );
+    for ( int i = 0; guess[ i ]; i++ ) {
+
+        //peel off this letter's digit, gray letters are shown in the
+        //default color like printFeedback does
+        int digit = code % FEEDBACK_BASE;
+        code /= FEEDBACK_BASE;
+        int color = digit == FEEDBACK_GREEN ? COLOR_GREEN : digit == FEEDBACK_YELLOW ? COLOR_YELLOW : COLOR_DEFAULT;
+        back[ row ][ i * 2 ] = (Cell) { guess[ i ], color };
+
+        //a letter keeps the best color it has earned on the keyboard
+        int earned = digit == FEEDBACK_GRAY ? COLOR_ABSENT : color;
+        int letter = guess[ i ] - LOWERCASE_A;
+        if ( earned > letterColors[ letter ] )
+            letterColors[ letter ] = earned;
+    }
+
+    drawKeyboard();
+}
+
+void screenStatus( int line, char const text[] )
+{
+    drawLine( STATUS_TOP + line, text );
+}
+
+void refreshScreen()
+{
+    for ( int r = 0; r < SCREEN_ROWS; r++ ) {
+        for ( int c = 0; c < SCREEN_COLS; c++ ) {
+            if ( !changed( r, c ) )
+                continue;
+
+            //a line that is blank from here on is cleared in one go
+            int end = c;
+            while ( end < SCREEN_COLS && back[ r ][ end ].ch == ' ' )
+                end++;
+            moveTo( r, c );
+            if ( end == SCREEN_COLS ) {
+                emit( "\x1b[K" );
+                memcpy( &front[ r ][ c ], &back[ r ][ c ], ( SCREEN_COLS - c ) * sizeof( Cell ) );
+                break;
+            }
+
+            setColor( back[ r ][ c ].color );
+            frame[ frameLen++ ] = back[ r ][ c ].ch;
+            front[ r ][ c ] = back[ r ][ c ];
+            cursorCol++;
+        }
+    }
+
+    //the guess is typed on a cleared line in the default color, and where
+    //the cursor ends up after it is not known
+    moveTo( INPUT_ROW, 0 );
+    setColor( COLOR_DEFAULT );
+    emit( "\x1b[K" );
+    cursorRow = -1;
+    sendFrame();
+}
+
+void endScreen()
+{
+    if ( !started )
+        return;
+
+    //whatever is printed next goes on the line the guess was typed on
+    refreshScreen();
+    started = false;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file screen.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-16
+ *
+ * Full-screen view of a game: the board of guesses, the letters of the
+ * keyboard in the best color each has earned, and two lines of messages,
+ * with the guess typed on the line below them. What is shown is drawn into
+ * a back buffer, and a refresh compares it with what the terminal already
+ * shows and only sends the cells that changed, with as few cursor moves
+ * and color changes as it can, so a guess costs a few dozen bytes.
+ *
+ */
+
+/** Line of the messages about the last guess */
+#define SCREEN_MESSAGE 0
+
+/** Line of the hint at the next guess */
+#define SCREEN_HINT 1
+
+/**
+ * Clears the terminal and draws the empty board. The cursor is left below
+ * the view when the program exits.
+ */
+void startScreen();
+
+/**
+ * Adds a guess at the bottom of the board, scrolling the oldest one off if
+ * the board is full, and colors the keyboard by its feedback.
+ *
+ * @param guess the word that was guessed
+ * @param code the feedback code of the guess
+ */
+void screenGuess( char const guess[], int code );
+
+/**
+ * Replaces one of the lines of messages, cutting it off at the width of
+ * the view.
+ *
+ * @param line SCREEN_MESSAGE or SCREEN_HINT
+ * @param text the new line, empty to clear it
+ */
+void screenStatus( int line, char const text[] );
+
+/**
+ * Sends the terminal the cells that changed since the last refresh, and
+ * puts the cursor at the start of a cleared line for the next guess.
+ */
+void refreshScreen();
+
+/**
+ * Refreshes the view one last time and leaves the cursor on the line below
+ * it, in the default color, so anything printed afterwards shows up after
+ * it. Does nothing if the view was never started or has already ended.
+ */
+void endScreen();
@@ -0,0 +1,364 @@
+/**
+ * @file solver.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-08
+ *
+ * Plays the game with the feedback index: keeps the set of answers still
+ * consistent with the feedback so far, and suggests the guess that leaves
+ * the fewest candidates on average. Used for hints while playing, for
+ * playing a game automatically, and for simulating a game for every word.
+ * In hard mode every guess must be consistent with the feedback so far, so
+ * the candidates are also the only guesses considered.
+ *
+ */
+#include "solver.h"
+#include "fbindex.h"
+#include "hintcache.h"
+#include "checkpoint.h"
+#include "lexicon.h"
+#include "feedback.h"
+#include "alloc.h"
+#include "pool.h"
+#include "metrics.h"
+
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <limits.h>
+
+/** Mixed into the hint cache keys of hard mode, whose best guesses differ */
+#define HARD_KEY 0x5bd1e9955bd1e995UL
+
+/** Number of words, which are both the guesses and the answers */
+static int numWords;
+
+/** Whether guesses must be consistent with the feedback so far */
+static bool hard;
+
+/** Number of guesses bestGuess has scored */
+static atomic_long guessesScored;
+
+/** The best first guess, when every word is a candidate */
+static int opener;
+
+/** The candidates of the game being played, in increasing order */
+static int *gameCandidates;
+static int gameCount;
+
+/** Whether every word is still a candidate, in which case gameCandidates is not filled in */
+static bool gameFull;
+
+/** Scratch group sizes for suggestGuess, one per feedback code */
+static int *gameGroups;
+
+/** The progress of simulateGames and its checkpoint file, shared by its tasks */
+static SimProgress progress;
+static char const *checkpointPath;
+
+/** Guards progress */
+static pthread_mutex_t progressLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Finds the guess that leaves the fewest candidates on average. A guess
+ * splits the candidates into groups by feedback, and a candidate in a
+ * group of size k leaves k, so the sum of k * k over the groups is what
+ * is minimized. With every word a candidate the group sizes are the
+ * lengths of the posting lists, otherwise they are counted. In hard mode
+ * only the candidates are scored as guesses.
+ *
+ * @param candidates the candidates in increasing order, or NULL for every word
+ * @param count the number of candidates
+ * @param groups scratch room for one count per feedback code, all zero,
+ *               and left all zero
+ * @return int the index of the best guess
+ */
+static int bestGuess( int const candidates[], int count, int groups[] )
+{
+    if ( count == 1 )
+        return candidates == NULL ? 0 : candidates[ 0 ];
+
+    int best = -1;
+    long bestScore = LONG_MAX;
+    bool bestIsCandidate = false;
+    int numCodes = feedbackCodes();
+
+    //guesses go in increasing order, so whether one is a candidate is
+    //found by walking the candidates alongside
+    bool onlyCandidates = hard && candidates != NULL;
+    int numGuesses = onlyCandidates ? count : numWords;
+    atomic_fetch_add( &guessesScored, numGuesses );
+    for ( int g = 0, next = 0; g < numGuesses; g++ ) {
+        int guess = onlyCandidates ? candidates[ g ] : g;
+        long score = 0;
+        bool isCandidate = true;
+
+        if ( candidates == NULL ) {
+            int const *list;
+            for ( int code = 0; code < numCodes; code++ ) {
+                long size = postingList( guess, code, &list );
+                score += size * size;
+            }
+        } else {
+            for ( int i = 0; i < count; i++ )
+                groups[ indexedFeedback( guess, candidates[ i ] ) ]++;
+
+            //clearing each group as it is counted leaves the scratch all zero
+            for ( int i = 0; i < count; i++ ) {
+                int code = indexedFeedback( guess, candidates[ i ] );
+                long size = groups[ code ];
+                score += size * size;
+                groups[ code ] = 0;
+            }
+
+            while ( next < count && candidates[ next ] < guess )
+                next++;
+            isCandidate = next < count && candidates[ next ] == guess;
+        }
+
+        //a candidate might be the answer, so it wins ties
+        if ( score < bestScore || ( score == bestScore && isCandidate && !bestIsCandidate ) ) {
+            best = guess;
+            bestScore = score;
+            bestIsCandidate = isCandidate;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Finds the best guess like bestGuess, but looks the candidate set up in
+ * the hint cache first, and remembers what it finds there.
+ *
+ * @param candidates the candidates in increasing order
+ * @param count the number of candidates
+ * @param groups scratch room for bestGuess
+ * @return int the index of the best guess
+ */
+static int cachedGuess( int const candidates[], int count, int groups[] )
+{
+    //one candidate is its own answer, not worth an entry
+    if ( count == 1 )
+        return candidates[ 0 ];
+
+    //the same set has its own entry in each mode, never 0
+    uint64_t key = candidateSetKey( candidates, count );
+    if ( hard && ( key ^= HARD_KEY ) == 0 )
+        key = 1;
+    int guess;
+    if ( !lookupHint( key, &guess ) ) {
+        guess = bestGuess( candidates, count, groups );
+        storeHint( key, guess );
+    }
+    return guess;
+}
+
+bool prepareSolver( long cacheEntries, bool hardMode )
+{
+    numWords = lexiconSize();
+    hard = hardMode;
+    if ( numWords == 0 || !buildFeedbackIndex() )
+        return false;
+
+    gameCandidates = countedMalloc( ALLOC_INDEX, numWords * sizeof( int ) );
+    gameGroups = countedMalloc( ALLOC_INDEX, feedbackCodes() * sizeof( int ) );
+    memset( gameGroups, 0, feedbackCodes() * sizeof( int ) );
+
+    //every game starts with every word a candidate, so they all open the same
+    opener = bestGuess( NULL, numWords, gameGroups );
+    initHintCache( cacheEntries );
+    resetCandidates();
+    return true;
+}
+
+bool isHardMode()
+{
+    return hard;
+}
+
+void resetCandidates()
+{
+    gameFull = true;
+    gameCount = numWords;
+}
+
+void narrowByGuess( char const guess[], int code )
+{
+    //a whole word is a prefix of exactly itself in a list of one length
+    int index;
+    prefixRange( guess, &index );
+
+    if ( gameFull ) {
+        int const *list;
+        gameCount = postingList( index, code, &list );
+        memcpy( gameCandidates, list, gameCount * sizeof( int ) );
+        gameFull = false;
+    } else {
+        gameCount = narrowCandidates( gameCandidates, gameCount, index, code, gameCandidates );
+    }
+}
+
+int remainingCandidates()
+{
+    return gameCount;
+}
+
+int suggestGuess()
+{
+    return gameFull ? opener : cachedGuess( gameCandidates, gameCount, gameGroups );
+}
+
+void simulateTargets( int first, int last, long histogram[] )
+{
+    int *candidates = countedMalloc( ALLOC_SESSION, numWords * sizeof( int ) );
+    int *groups = countedMalloc( ALLOC_SESSION, feedbackCodes() * sizeof( int ) );
+    memset( groups, 0, feedbackCodes() * sizeof( int ) );
+
+    for ( int target = first; target < last; target++ ) {
+        //the first narrowing copies a posting list, later ones intersect in place
+        int guess = opener, guesses = 1, count = numWords;
+        for ( ; guess != target && guesses < MAX_SIM_GUESSES; guesses++ ) {
+            int code = indexedFeedback( guess, target );
+            if ( count == numWords ) {
+                int const *list;
+                count = postingList( guess, code, &list );
+                memcpy( candidates, list, count * sizeof( int ) );
+            } else {
+                count = narrowCandidates( candidates, count, guess, code, candidates );
+            }
+            guess = cachedGuess( candidates, count, groups );
+        }
+        histogram[ guesses ]++;
+    }
+
+    countedFree( ALLOC_SESSION, groups );
+    countedFree( ALLOC_SESSION, candidates );
+}
+
+/**
+ * Body of the parallel simulation, one chunk of targets per index. Chunks
+ * a checkpoint says are done are skipped.
+ *
+ * @param ctx unused
+ * @param start the first chunk
+ * @param end one past the last chunk
+ */
+static void simulateRange( void *ctx, long start, long end )
+{
+    for ( long chunk = start; chunk < end; chunk++ ) {
+        if ( progress.done[ chunk ] )
+            continue;
+
+        long histogram[ MAX_SIM_GUESSES + 1 ] = { 0 };
+        int first = chunk * SIMULATE_CHUNK;
+        int last = first + SIMULATE_CHUNK < numWords ? first + SIMULATE_CHUNK : numWords;
+        simulateTargets( first, last, histogram );
+
+        pthread_mutex_lock( &progressLock );
+        finishChunk( &progress, chunk, histogram, checkpointPath );
+        pthread_mutex_unlock( &progressLock );
+    }
+}
+
+void simulateGames( FILE *out, char const checkpoint[] )
+{
+    int numChunks = ( numWords + SIMULATE_CHUNK - 1 ) / SIMULATE_CHUNK;
+    checkpointPath = checkpoint;
+    startProgress( &progress, numChunks, checkpoint );
+
+    parallelFor( numChunks, 1, simulateRange, NULL );
+    if ( checkpoint != NULL )
+        saveCheckpoint( &progress, checkpoint );
+
+    fprintf( out, "opener %s\n", lexiconWord( opener ) );
+    printHistogram( out, progress.histogram );
+
+    long hits, misses, evictions;
+    hintCacheStats( &hits, &misses, &evictions );
+    fprintf( out, "hint cache: %ld hits, %ld misses, %ld evictions\n", hits, misses, evictions );
+    freeProgress( &progress );
+}
+
+void printHistogram( FILE *out, long const histogram[] )
+{
+    long games = 0, guesses = 0, lost = 0;
+    int worst = 0;
+    for ( int g = 1; g <= MAX_SIM_GUESSES; g++ ) {
+        games += histogram[ g ];
+        guesses += histogram[ g ] * g;
+        if ( g > WINNING_GUESSES )
+            lost += histogram[ g ];
+        if ( histogram[ g ] > 0 )
+            worst = g;
+    }
+
+    fprintf( out, "%7s  %7s\n", "guesses", "games" );
+    for ( int g = 1; g <= worst; g++ )
+        fprintf( out, "%7d  %7ld\n", g, histogram[ g ] );
+    fprintf( out, "%ld games, %.4f guesses on average, %ld over %d guesses\n", games,
+             games > 0 ? (double) guesses / games : 0.0, lost, WINNING_GUESSES );
+}
+
+/**
+ * Body of the benchmark's simulation, one chunk of targets per index.
+ *
+ * @param ctx the histogram the chunks are added to, guarded by progressLock
+ * @param start the first chunk
+ * @param end one past the last chunk
+ */
+static void benchmarkRange( void *ctx, long start, long end )
+{
+    long *total = ctx;
+    for ( long chunk = start; chunk < end; chunk++ ) {
+        long histogram[ MAX_SIM_GUESSES + 1 ] = { 0 };
+        int first = chunk * SIMULATE_CHUNK;
+        int last = first + SIMULATE_CHUNK < numWords ? first + SIMULATE_CHUNK : numWords;
+        simulateTargets( first, last, histogram );
+
+        pthread_mutex_lock( &progressLock );
+        for ( int g = 0; g <= MAX_SIM_GUESSES; g++ )
+            total[ g ] += histogram[ g ];
+        pthread_mutex_unlock( &progressLock );
+    }
+}
+
+void benchmarkHardMode( FILE *out )
+{
+    int numChunks = ( numWords + SIMULATE_CHUNK - 1 ) / SIMULATE_CHUNK;
+    bool wasHard = hard;
+
+    fprintf( out, "%d words, opener %s\n", numWords, lexiconWord( opener ) );
+    char lostLabel[ 16 ];
+    snprintf( lostLabel, sizeof( lostLabel ), "over %d", WINNING_GUESSES );
+    fprintf( out, "%-7s  %10s  %8s  %14s  %16s  %8s  %6s\n", "mode", "ms", "states", "guesses scored",
+             "guesses a state", "average", lostLabel );
+    for ( int mode = 0; mode < 2; mode++ ) {
+        //the modes keep their states apart in the hint cache, so neither
+        //finds the other's work there
+        hard = mode == 1;
+        long hits, misses, evictions;
+        hintCacheStats( &hits, &misses, &evictions );
+        long missesBefore = misses;
+        long scoredBefore = atomic_load( &guessesScored );
+
+        long histogram[ MAX_SIM_GUESSES + 1 ] = { 0 };
+        long start = monotonicNanos();
+        parallelFor( numChunks, 1, benchmarkRange, histogram );
+        double ms = ( monotonicNanos() - start ) / 1e6;
+
+        hintCacheStats( &hits, &misses, &evictions );
+        long states = misses - missesBefore;
+        long scored = atomic_load( &guessesScored ) - scoredBefore;
+        long games = 0, guesses = 0, lost = 0;
+        for ( int g = 1; g <= MAX_SIM_GUESSES; g++ ) {
+            games += histogram[ g ];
+            guesses += histogram[ g ] * g;
+            if ( g > WINNING_GUESSES )
+                lost += histogram[ g ];
+        }
+        fprintf( out, "%-7s  %10.1f  %8ld  %14ld  %16.1f  %8.4f  %6ld\n", hard ? "hard" : "normal", ms, states, scored,
+                 states > 0 ? (double) scored / states : 0.0, games > 0 ? (double) guesses / games : 0.0, lost );
+    }
+
+    hard = wasHard;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file solver.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-08
+ *
+ * Plays the game with the feedback index: keeps the set of answers still
+ * consistent with the feedback so far, and suggests the guess that leaves
+ * the fewest candidates on average. Used for hints while playing, for
+ * playing a game automatically, and for simulating a game for every word.
+ *
+ */
+#include <stdbool.h>
+#include <stdio.h>
+
+/** Longest game the simulation tracks, longer games are counted here too */
+#define MAX_SIM_GUESSES 16
+
+/** Targets simulated at a time, and the unit of progress the simulation saves */
+#define SIMULATE_CHUNK 64
+
+/** Longest game that still counts as a win in the simulation summary */
+#define WINNING_GUESSES 6
+
+/**
+ * Builds the feedback index over the sorted list of words chosen in the
+ * lexicon, finds the best opener, and makes room for one game's
+ * candidates and for the hint cache. Must be called before any other
+ * solver function.
+ *
+ * @param cacheEntries the most game states the hint cache remembers
+ * @param hardMode whether guesses must be consistent with the feedback so far
+ * @return true if the solver is ready
+ * @return false if the list is empty or too long to index
+ */
+bool prepareSolver( long cacheEntries, bool hardMode );
+
+/**
+ * Returns whether the solver plays in hard mode.
+ *
+ * @return true if guesses must be consistent with the feedback so far
+ * @return false if else
+ */
+bool isHardMode();
+
+/**
+ * Starts a new game: every word is a candidate again.
+ */
+void resetCandidates();
+
+/**
+ * Narrows the candidates of the game to those consistent with a guess
+ * and the feedback it got.
+ *
+ * @param guess the guess, a word of the list
+ * @param code the feedback it got
+ */
+void narrowByGuess( char const guess[], int code );
+
+/**
+ * Returns the number of candidates left in the game.
+ *
+ * @return int the number of candidates
+ */
+int remainingCandidates();
+
+/**
+ * Returns the best guess for the candidates left in the game: the word
+ * that leaves the fewest candidates on average, preferring candidates,
+ * then the first in the list. In hard mode only candidates are guessed.
+ * Sets of candidates seen before, in this game or another, are answered
+ * from the hint cache.
+ *
+ * @return int the index of the guess in the lexicon
+ */
+int suggestGuess();
+
+/**
+ * Plays a game against every target from first to last - 1 and counts the
+ * games by their number of guesses.
+ *
+ * @param first the first target
+ * @param last one past the last target
+ * @param histogram where the counts are added, histogram[ g ] counting the
+ *                  games solved in g guesses, MAX_SIM_GUESSES + 1 of them
+ */
+void simulateTargets( int first, int last, long histogram[] );
+
+/**
+ * Plays a game against every word of the list, spread across the pool a
+ * chunk of targets at a time, and prints how many guesses the games took.
+ * Progress is saved to a checkpoint now and then, and a run resumes from
+ * the checkpoint if it has one for this list.
+ *
+ * @param out the file the results are printed to
+ * @param checkpoint the checkpoint file, or NULL for none
+ */
+void simulateGames( FILE *out, char const checkpoint[] );
+
+/**
+ * Prints a summary of simulated games: how many took each number of
+ * guesses, the average, and how many took more than WINNING_GUESSES.
+ *
+ * @param out the file the summary is printed to
+ * @param histogram the counts of games by number of guesses
+ */
+void printHistogram( FILE *out, long const histogram[] );
+
+/**
+ * Simulates a game against every word in normal mode and then in hard
+ * mode, and prints how long each took, how many game states were solved,
+ * how many guesses were scored to solve them, and how the games went.
+ *
+ * @param out the file the results are printed to
+ */
+void benchmarkHardMode( FILE *out );
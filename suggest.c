@@ -0,0 +1,97 @@
+/**
+ * @file suggest.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-25
+ *
+ * Suggests the valid words closest to a rejected guess. Every word of the
+ * chosen list is packed into one 64-bit integer with a byte per letter, so
+ * the number of letters two words differ in (their Hamming distance) takes
+ * a handful of bitwise operations, and the whole list is scanned in a
+ * tight loop over one array.
+ *
+ */
+#include "suggest.h"
+#include "lexicon.h"
+#include "alloc.h"
+
+#include <stdint.h>
+
+/** The low seven bits of every byte */
+#define LOW_SEVEN_BITS 0x7f7f7f7f7f7f7f7fULL
+
+/** The high bit of every byte */
+#define HIGH_BITS 0x8080808080808080ULL
+
+/** The packed words of the list, in the same order as the list */
+static uint64_t *packed;
+
+/** The number of packed words */
+static int numPacked;
+
+/**
+ * Packs up to MAX_WORD_LEN letters into an integer, one byte per letter.
+ *
+ * @param word the word being packed
+ * @return uint64_t the packed word
+ */
+static uint64_t pack( char const word[] )
+{
+    uint64_t value = 0;
+    for ( int i = 0; word[ i ]; i++ )
+        value |= (uint64_t) (unsigned char) word[ i ] << ( 8 * i );
+    return value;
+}
+
+/**
+ * Counts the letters two packed words differ in: the nonzero bytes of
+ * their exclusive or. Adding 0x7f to the low bits of a byte carries into
+ * its high bit exactly when the low bits are nonzero, so after or-ing in
+ * the byte itself, each differing byte has its high bit set.
+ *
+ * @param a the first packed word
+ * @param b the second packed word
+ * @return int the number of differing letters
+ */
+static int distance( uint64_t a, uint64_t b )
+{
+    uint64_t x = a ^ b;
+    uint64_t nonzero = ( ( ( x & LOW_SEVEN_BITS ) + LOW_SEVEN_BITS ) | x ) & HIGH_BITS;
+    return __builtin_popcountll( nonzero );
+}
+
+void prepareSuggestions()
+{
+    countedFree( ALLOC_INDEX, packed );
+
+    numPacked = lexiconSize();
+    packed = countedMalloc( ALLOC_INDEX, numPacked * sizeof( uint64_t ) );
+    for ( int i = 0; i < numPacked; i++ )
+        packed[ i ] = pack( lexiconWord( i ) );
+}
+
+int suggestWords( char const word[], int found[] )
+{
+    uint64_t key = pack( word );
+    int distances[ MAX_SUGGESTIONS ];
+    int count = 0;
+
+    for ( int i = 0; i < numPacked; i++ ) {
+        int d = distance( key, packed[ i ] );
+
+        //most words are too far away or no closer than the worst suggestion so far
+        if ( d > MAX_SUGGEST_DISTANCE || ( count == MAX_SUGGESTIONS && d >= distances[ count - 1 ] ) )
+            continue;
+
+        //insert the word in order of distance, after words at the same distance
+        int k = count < MAX_SUGGESTIONS ? count++ : count - 1;
+        while ( k > 0 && distances[ k - 1 ] > d ) {
+            distances[ k ] = distances[ k - 1 ];
+            found[ k ] = found[ k - 1 ];
+            k--;
+        }
+        distances[ k ] = d;
+        found[ k ] = i;
+    }
+
+    return count;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file suggest.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-25
+ *
+ * Suggests the valid words closest to a rejected guess. Every word of the
+ * chosen list is packed into one 64-bit integer with a byte per letter, so
+ * the number of letters two words differ in (their Hamming distance) takes
+ * a handful of bitwise operations, and the whole list is scanned in a
+ * tight loop over one array.
+ *
+ */
+#include <stdbool.h>
+
+/** Most words suggested for one guess */
+#define MAX_SUGGESTIONS 3
+
+/** Words that differ from the guess in more letters than this are not suggested */
+#define MAX_SUGGEST_DISTANCE 2
+
+/**
+ * Packs the sorted list of words chosen in the lexicon for suggestWords.
+ * Must be called again if the list changes.
+ */
+void prepareSuggestions();
+
+/**
+ * Finds up to MAX_SUGGESTIONS words of the list that differ from word in
+ * the fewest letters, closest first and alphabetically among equals.
+ *
+ * @param word the rejected guess, wordLength() lowercase letters
+ * @param found where the lexicon indices of the suggestions are stored
+ * @return int the number of suggestions found
+ */
+int suggestWords( char const word[], int found[] );
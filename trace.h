@@ -0,0 +1,81 @@
+/**
+ * @file trace.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-03-12
+ *
+ * Static tracepoints on the hot paths of the game, in the "wordle" provider.
+ * When <sys/sdt.h> is available they are USDT probes that perf and bpftrace
+ * can attach to without rebuilding, and they compile to a single nop until
+ * something attaches. Without the header they compile to nothing. Every
+ * probe has a semaphore that is raised while a tracer is attached, so a
+ * probe on a path too hot to time all the time only times it then.
+ *
+ * Probes and their arguments:
+ *   lexicon_load_start(filename)
+ *   lexicon_load_end(filename, words, nanos)
+ *   sort_start(words)
+ *   sort_end(words, nanos)
+ *   lookup(word, found, nanos)
+ *   feedback(guess, target, len, code, nanos), guess and target being len
+ *     letters that are not always null-terminated
+ *   game_start(target, seed)
+ *   game_end(target, guesses)
+ *   score_update(guesses)
+ *
+ */
+#if defined( __has_include )
+#if __has_include( <sys/sdt.h> )
+#define HAVE_SYS_SDT 1
+#endif
+#endif
+
+#ifdef HAVE_SYS_SDT
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+/** Declares, or defines in the one file that defines TRACE_DEFINE_SEMAPHORES, a probe's semaphore */
+#ifdef TRACE_DEFINE_SEMAPHORES
+#define TRACE_SEMAPHORE( name ) unsigned short wordle_##name##_semaphore __attribute__( ( section( ".probes" ) ) )
+#else
+#define TRACE_SEMAPHORE( name ) extern unsigned short wordle_##name##_semaphore
+#endif
+
+TRACE_SEMAPHORE( lexicon_load_start );
+TRACE_SEMAPHORE( lexicon_load_end );
+TRACE_SEMAPHORE( sort_start );
+TRACE_SEMAPHORE( sort_end );
+TRACE_SEMAPHORE( lookup );
+TRACE_SEMAPHORE( feedback );
+TRACE_SEMAPHORE( game_start );
+TRACE_SEMAPHORE( game_end );
+TRACE_SEMAPHORE( score_update );
+
+/** Whether a tracer is attached to the probe name */
+#define TRACE_ENABLED( name ) __builtin_expect( wordle_##name##_semaphore != 0, 0 )
+
+/** Fires the probe name of the wordle provider with one argument */
+#define TRACE1( name, a ) DTRACE_PROBE1( wordle, name, a )
+
+/** Fires the probe name of the wordle provider with two arguments */
+#define TRACE2( name, a, b ) DTRACE_PROBE2( wordle, name, a, b )
+
+/** Fires the probe name of the wordle provider with three arguments */
+#define TRACE3( name, a, b, c ) DTRACE_PROBE3( wordle, name, a, b, c )
+
+/** Fires the probe name of the wordle provider with five arguments */
+#define TRACE5( name, a, b, c, d, e ) DTRACE_PROBE5( wordle, name, a, b, c, d, e )
+
+#else
+
+//no tracer can attach, so code only run for one is left out
+#define TRACE_ENABLED( name ) 0
+
+//the arguments are still evaluated as void so timing variables used only
+//by a probe do not trigger unused warnings
+#define TRACE1( name, a ) ( (void) ( a ) )
+#define TRACE2( name, a, b ) ( (void) ( a ), (void) ( b ) )
+#define TRACE3( name, a, b, c ) ( (void) ( a ), (void) ( b ), (void) ( c ) )
+#define TRACE5( name, a, b, c, d, e ) ( (void) ( a ), (void) ( b ), (void) ( c ), (void) ( d ), (void) ( e ) )
+
+#endif
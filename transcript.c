@@ -0,0 +1,271 @@
+/**
+ * @file transcript.c
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-18
+ *
+ * Records games compactly and expands them back into the text the game
+ * printed. A game is its seed followed by each guess as its index in the
+ * sorted list and its feedback code, so a game of a few guesses takes a
+ * couple dozen bytes instead of lines of colored text. Games are appended
+ * to the transcript one after another, and the list they were played on
+ * is needed to expand them.
+ *
+ */
+#include "transcript.h"
+#include "feedback.h"
+#include "lexicon.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/** Marks the start of a transcript file */
+#define TRANSCRIPT_MAGIC "WTRN"
+
+/** Number of bytes in TRANSCRIPT_MAGIC */
+#define MAGIC_LEN 4
+
+/** Bits of a value each byte of a varint holds */
+#define VARINT_BITS 7
+
+/** Set on every byte of a varint but the last */
+#define VARINT_MORE 0x80
+
+/** Most bytes of a varint of an unsigned long */
+#define MAX_VARINT_BYTES 10
+
+/** Number of feedback codes that fit in one byte */
+#define ONE_BYTE_CODES 256
+
+/** The transcript the game is appended to, or NULL */
+static FILE *transcript;
+
+/**
+ * Writes a varint.
+ *
+ * @param fp the file written to
+ * @param value the value
+ */
+static void writeVarint( FILE *fp, unsigned long value )
+{
+    while ( value >= VARINT_MORE ) {
+        putc( ( value & ( VARINT_MORE - 1 ) ) | VARINT_MORE, fp );
+        value >>= VARINT_BITS;
+    }
+    putc( value, fp );
+}
+
+/**
+ * Reads a varint.
+ *
+ * @param fp the file read from
+ * @param value where the value is stored
+ * @return true if a whole varint was read
+ * @return false if the file ended first or the varint is too long
+ */
+static bool readVarint( FILE *fp, unsigned long *value )
+{
+    *value = 0;
+    for ( int i = 0; i < MAX_VARINT_BYTES; i++ ) {
+        int byte = getc( fp );
+        if ( byte == EOF )
+            return false;
+        *value |= (unsigned long) ( byte & ( VARINT_MORE - 1 ) ) << ( i * VARINT_BITS );
+        if ( !( byte & VARINT_MORE ) )
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Returns the number of feedback codes of words of the length in use.
+ *
+ * @return int 3 ^ wordLength()
+ */
+static int numCodes()
+{
+    int codes = 1;
+    for ( int i = 0; i < wordLength(); i++ )
+        codes *= FEEDBACK_BASE;
+    return codes;
+}
+
+/**
+ * Returns the index of a word in the sorted list.
+ *
+ * @param word the word, in the list
+ * @return int its index
+ */
+static int indexOf( char const word[] )
+{
+    //a whole word is a prefix of exactly itself in a list of one length
+    int index;
+    prefixRange( word, &index );
+    return index;
+}
+
+/**
+ * Writes the header of a new transcript: the list's fingerprint and the
+ * length of the words the games are played with.
+ *
+ * @param fp the transcript, at its start
+ */
+static void writeHeader( FILE *fp )
+{
+    uint64_t fingerprint = lexiconFingerprint( currentLexicon() );
+    fwrite( TRANSCRIPT_MAGIC, 1, MAGIC_LEN, fp );
+    fwrite( &fingerprint, sizeof( fingerprint ), 1, fp );
+    putc( wordLength(), fp );
+}
+
+/**
+ * Reads the header of a transcript and checks that its games were played
+ * on the list in use, with words of the length in use.
+ *
+ * @param fp the transcript, at its start
+ * @return true if the header is whole and matches the list and length
+ * @return false if else
+ */
+static bool readHeader( FILE *fp )
+{
+    char magic[ MAGIC_LEN ];
+    uint64_t fingerprint;
+    return fread( magic, 1, MAGIC_LEN, fp ) == MAGIC_LEN && memcmp( magic, TRANSCRIPT_MAGIC, MAGIC_LEN ) == 0 &&
+           fread( &fingerprint, sizeof( fingerprint ), 1, fp ) == 1 && fingerprint == lexiconFingerprint( currentLexicon() ) &&
+           getc( fp ) == wordLength();
+}
+
+bool startTranscript( char const path[], long seed )
+{
+    transcript = fopen( path, "a+b" );
+    if ( transcript == NULL ) {
+        fprintf( stderr, "Can't write the transcript: %s\n", path );
+        return false;
+    }
+
+    //a new transcript starts with the list's fingerprint and word length,
+    //and the games of one transcript are all played with those words
+    fseek( transcript, 0, SEEK_END );
+    if ( ftell( transcript ) == 0 ) {
+        writeHeader( transcript );
+    } else {
+        rewind( transcript );
+        if ( !readHeader( transcript ) ) {
+            fprintf( stderr, "The transcript is not of this word list and length: %s\n", path );
+            fclose( transcript );
+            transcript = NULL;
+            return false;
+        }
+
+        //a stream that was read from must be positioned before it is written to
+        fseek( transcript, 0, SEEK_END );
+    }
+
+    writeVarint( transcript, seed );
+    return true;
+}
+
+void recordGuess( char const guess[], int code )
+{
+    if ( transcript == NULL )
+        return;
+
+    //0 is left to end the guesses
+    writeVarint( transcript, indexOf( guess ) + 1 );
+    putc( code & 0xff, transcript );
+    if ( numCodes() > ONE_BYTE_CODES )
+        putc( code >> 8, transcript );
+}
+
+void finishTranscript( bool solved, char const target[] )
+{
+    if ( transcript == NULL )
+        return;
+
+    writeVarint( transcript, 0 );
+    if ( !solved )
+        writeVarint( transcript, indexOf( target ) );
+
+    if ( fclose( transcript ) != 0 )
+        fprintf( stderr, "Can't write the transcript\n" );
+    transcript = NULL;
+}
+
+/**
+ * Exits with the error for a transcript that can't be expanded.
+ *
+ * @param fp the transcript
+ */
+static void invalidTranscript( FILE *fp )
+{
+    fprintf( stderr, "Invalid transcript file\n" );
+    fclose( fp );
+    exit( EXIT_FAILURE );
+}
+
+void expandTranscript( char const path[] )
+{
+    FILE *fp = fopen( path, "rb" );
+    if ( fp == NULL ) {
+        fprintf( stderr, "Can't open file: %s\n", path );
+        exit( EXIT_FAILURE );
+    }
+
+    //an empty transcript has no games, and so no header either
+    int codes = numCodes();
+    int next = getc( fp );
+    if ( next != EOF ) {
+        ungetc( next, fp );
+        if ( !readHeader( fp ) ) {
+            fprintf( stderr, "The transcript is not of this word list and length: %s\n", path );
+            fclose( fp );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    while ( ( next = getc( fp ) ) != EOF ) {
+        ungetc( next, fp );
+
+        //the seed is not needed to print the game
+        unsigned long seed;
+        if ( !readVarint( fp, &seed ) )
+            invalidTranscript( fp );
+
+        //the guesses up to the 0 that ends them
+        int guesses = 0;
+        bool solved = false;
+        unsigned long entry;
+        while ( true ) {
+            if ( !readVarint( fp, &entry ) || entry > lexiconSize() )
+                invalidTranscript( fp );
+            if ( entry == 0 )
+                break;
+
+            int low = getc( fp );
+            int high = codes > ONE_BYTE_CODES ? getc( fp ) : 0;
+            if ( low == EOF || high == EOF )
+                invalidTranscript( fp );
+            int code = low | high << 8;
+            if ( code >= codes )
+                invalidTranscript( fp );
+
+            //a winning guess is not printed, and ends the game
+            guesses++;
+            solved = code == codes - 1;
+            if ( !solved )
+                printFeedback( lexiconWord( entry - 1 ), code );
+        }
+
+        if ( solved ) {
+            fprintf( stdout, guesses == 1 ? "Solved in %d guess\n" : "Solved in %d guesses\n", guesses );
+        } else {
+            unsigned long target;
+            if ( !readVarint( fp, &target ) || target >= lexiconSize() )
+                invalidTranscript( fp );
+            fprintf( stdout, "The word was \"%s\"\n", lexiconWord( target ) );
+        }
+    }
+
+    fclose( fp );
+}
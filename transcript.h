@@ -0,0 +1,65 @@
+/**
+ * @file transcript.h
+ * @author Yousif Mansour - yamansou
+ * @date 2022-04-18
+ *
+ * Records games compactly and expands them back into the text the game
+ * printed. A game is its seed followed by each guess as its index in the
+ * sorted list and its feedback code, so a game of a few guesses takes a
+ * couple dozen bytes instead of lines of colored text. Games are appended
+ * to the transcript one after another, and the list they were played on
+ * is needed to expand them.
+ *
+ * A transcript starts with "WTRN", the 8-byte fingerprint of the list its
+ * games were played on and a byte with the length of their words, and is
+ * only added to or expanded with that list and length. A game is laid
+ * out as:
+ *   the seed, as a varint
+ *   every guess as the varint of its index + 1, then its feedback code in
+ *     one byte, or two for words whose codes do not fit in one
+ *   a 0 varint ending the guesses
+ *   the varint of the target's index, only if the game was not solved
+ * Varints hold 7 bits a byte, least significant first, with the top bit
+ * set on every byte but the last.
+ *
+ */
+#include <stdbool.h>
+
+/**
+ * Opens the transcript a game is appended to and records its seed. The
+ * guesses are recorded as they are made. Prints an error if the
+ * transcript can't be written or is of another list or length.
+ *
+ * @param path the transcript file
+ * @param seed the seed of the game
+ * @return true if the transcript is open
+ * @return false if it can't be written or is of another list or length
+ */
+bool startTranscript( char const path[], long seed );
+
+/**
+ * Records a guess of the game, if a transcript is open.
+ *
+ * @param guess the word that was guessed, in the sorted list
+ * @param code the feedback code of the guess
+ */
+void recordGuess( char const guess[], int code );
+
+/**
+ * Ends the game in the transcript and closes it, if one is open.
+ *
+ * @param solved whether the last guess was the target
+ * @param target the target word, in the sorted list
+ */
+void finishTranscript( bool solved, char const target[] );
+
+/**
+ * Prints every game of a transcript to stdout the way the game printed
+ * it: each guess but a winning one in its colors, and then how the game
+ * ended. The sorted list the games were played on must be in use, with
+ * the same length chosen. Exits with an error if the transcript is of
+ * another list or length, or cut off.
+ *
+ * @param path the transcript file
+ */
+void expandTranscript( char const path[] );
@@ -7,141 +7,198 @@
  * has to guess a random 5-letter target word by making guesses and learning more 
  * and more about how close their guess is to the target word. 
  * 
- * Takes two command-line arguments: <word-list-file> [seed-number]
+ * Takes two command-line arguments: [options] <word-list-file> [seed-number]
  * 
  * word-list-file : Represents the list of words that are part of the lexicon of the current game. 
- *                    Must be a file containing only WORD_LEN long words seperated by line feeds.
+ *                    Must be a file containing only WORD_LEN long words seperated by line feeds,
+ *                    unless a --length is given.
  * 
  * seed-number : used to randomly select the target word chosen from the list of words.
  *                 must be a positive long integer.
  * 
  * Keeps track of the the number of guesses it took the player to win in a file named "scores.txt"
  * 
+ * options : given before the word-list-file, each starting with "--".
+ *             --metrics <socket-path> serves Prometheus metrics on a Unix socket while playing.
+ *             --stats prints allocation counts per subsystem to stderr when the program exits.
+ *             --rank-openers ranks every word as a first guess instead of playing a game.
+ *             --cover <n> finds the n words that cover the most distinct letters instead of playing.
+ *             --by-frequency makes --cover weigh letters by how often they appear in the list.
+ *             --external-sort <output-file> sorts a list of any size into output-file instead of playing.
+ *             --memory-cap <bytes>[K|M|G] caps the memory --external-sort holds words in.
+ *             --ladder <from> <to> prints the shortest word ladder between two words instead of playing.
+ *             --graph-cache <file> loads the --ladder graph from file, or saves it there once built.
+ *             --complete shows completions of a guess while it is typed at a terminal.
+ *             --suggest suggests the closest valid words when a guess is not in the list.
+ *             --bench-ef compares the list with its Elias-Fano encoding instead of playing.
+ *             --threads <n> runs parallel work on n threads instead of one per core.
+ *             --pin pins every thread of the pool to its own core.
+ *             --bench-pool measures how the thread pool scales instead of playing.
+ *             --lenient lowercases the list and drops whitespace at the ends of its lines before checking it.
+ *             --hints prints the best next guess and the number of words left after every guess.
+ *             --auto-play plays the game with the best guesses instead of reading them.
+ *             --simulate plays a game against every word and prints how many guesses they took.
+ *             --hint-cache <entries>[K|M|G] sizes the cache of best guesses for --hints, --auto-play and --simulate.
+ *             --workers <n> spreads --simulate across n worker processes.
+ *             --checkpoint <file> saves the progress of --simulate to file now and then, and resumes from it.
+ *             --tui shows the game full-screen, with the board and the colors the letters have earned.
+ *             --transcript <file> appends a compact record of the game to file.
+ *             --expand <file> prints the games recorded in a transcript instead of playing.
+ *             --hard makes the solver, --simulate and --rank-openers keep every guess consistent with the feedback so far.
+ *             --bench-hard simulates a game against every word in normal and hard mode and compares them instead of playing.
+ *             --bench-fingerprint measures how fast the list is fingerprinted instead of playing.
+ *             --round <n> plays round n of the no-repeat schedule chosen by the seed.
+ *             --length <n> accepts a list of MIN_WORD_LEN to MAX_WORD_LEN letter words and
+ *                          plays with the n letter words.
+ * 
  */
 #include "io.h"
 #include "lexicon.h"
 #include "history.h"
+#include "metrics.h"
+#include "alloc.h"
+//the semaphores of the tracepoints are defined with the game
+#define TRACE_DEFINE_SEMAPHORES
+#include "trace.h"
+#include "feedback.h"
+#include "rank.h"
+#include "cover.h"
+#include "extsort.h"
+#include "complete.h"
+#include "suggest.h"
+#include "ladder.h"
+#include "registry.h"
+#include "eliasfano.h"
+#include "pool.h"
+#include "solver.h"
+#include "hintcache.h"
+#include "distsim.h"
+#include "screen.h"
+#include "transcript.h"
+#include "fingerprint.h"
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
+#include <limits.h>
 
 /** The number of colors that can be printed */
 #define NUM_COLORS 3
 
-/** The index of the input-file name in the cmnd-line arguments array */
-#define FILE_ARG_INDEX 1
+/** Most characters of a line of suggestions for a rejected guess or of a hint */
+#define MESSAGE_LINE_LEN ( 16 + MAX_SUGGESTIONS * ( MAX_WORD_LEN + 2 ) )
 
-/** The index of the seed in the cmnd-line arguments array */
-#define SEED_ARG_INDEX 2
+/** What a player types to give up, whatever the length of the words */
+#define QUIT_COMMAND "quit"
 
-/**
- * Prints the correct usage for the command-line arguments and exits
- * with system failure
- */
-static void printUsageError()
-{
-    fprintf( stderr, "usage: wordle <word-list-file> [seed-number]" );
-    exit( EXIT_FAILURE );
-}
+/** The index of the input-file name among the positional cmnd-line arguments */
+#define FILE_ARG_INDEX 0
 
-/**
- * Process the user's guess using the provided rules of wordle.
- * Prints each character in the user's guess in the appropriate color.
- * @param userWord The word that the user guessed
- * @param targetWord The target word in this game of wordle
- *        precondtion: Both userWord and targetWord are valid words from the wordList
- */
-static void processWord( char userWord[], char targetWord[] )
-{    
+/** The index of the seed among the positional cmnd-line arguments */
+#define SEED_ARG_INDEX 1
 
-    //arbitrary integers chosen to represent the three printable colors
-    short const green = 0, yellow = 1, defaultColor = 2;
+/** Options given on the command line before the word list file */
+typedef struct {
+    /** Path of the Unix socket metrics are served on, or NULL */
+    char *metricsSocket;
 
-    //keeps track of the current color being printed 
-    //effectively works as a state machine
-    short currentColor = defaultColor;
+    /** Whether allocation statistics are printed on exit */
+    bool stats;
 
-    //Here, I generate a truth table for every character in the target word. 
-    //Effectively, targetLetterUsed[ n ] being true means that the 
-    //character targetWord[ n ] has a userWord character that is "tied" to it.
-    //userWord characters become "tied" to a targetWord character when they are found equal
-    //to a targetWord character. Being "tied" is a one-to-one relationship, meaning each targetWord 
-    //character can only be tied to one userWord character. This is used to print out the exact 
-    //number of green and yellow characters for targetWords and userWords with duplicate letters.
-    
-    //initailize the truth table to mark correctly guessed characters (green characters) as tied
-    bool targetLetterUsed[ WORD_LEN ];
-    for ( int i = 0; userWord[ i ]; i++ )
-        targetLetterUsed[ i ] = userWord[ i ] == targetWord[ i ];
+    /** Whether every word is ranked as a first guess instead of playing */
+    bool rankOpeners;
 
-    //for every character that the user guessed
-    for ( int i = 0; userWord[ i ]; i++ ) {
+    /** Number of words in the covering set to search for, or 0 */
+    int coverWords;
 
-        //if it is in the correct position, print it green and go on to next character
-        if ( userWord[ i ] == targetWord[ i ] ) {
+    /** Whether the covering set weighs letters by frequency */
+    bool byFrequency;
 
-            //sets current color to green if it isn't already and prints character
-            if ( currentColor != green ) {
-                colorGreen();
-                currentColor = green;
-            }
+    /** File the list is externally sorted into, or NULL */
+    char *sortOutput;
 
-            putc( userWord[ i ], stdout );
+    /** Most bytes of words the external sort holds in memory */
+    long memoryCap;
 
-            //go on to next character
-            continue;
-        }
+    /** Length of the words to play with from a list of mixed lengths, or 0 */
+    int length;
 
-        //keep track if character was printed yellow
-        bool charYellowPrinted = false;
+    /** Round of the seed's schedule to play, or -1 to pick a word from the seed alone */
+    long round;
 
-        //for all characters in the targetWord
-        for ( int j = 0; targetWord[ j ]; j++ ) {
+    /** Whether completions are shown while typing at a terminal */
+    bool complete;
 
-            //if the character that the user guessed is equal to a target in any 
-            //position j AND if that target character is not already tied to a user character...
-            if ( userWord[ i ] == targetWord[ j ] && !targetLetterUsed[ j ] ) {
+    /** Whether the closest valid words are suggested for rejected guesses */
+    bool suggest;
 
-                //mark that this target character is now tied
-                targetLetterUsed[ j ] = true;
+    /** The words the ladder goes from and to, or NULL */
+    char *ladderFrom;
+    char *ladderTo;
 
-                //sets current color to yellow if it isn't already
-                if ( currentColor != yellow ) {
-                    colorYellow();
-                    currentColor = yellow;
-                }
-                
-                //prints character in yellow and flags that a yellow character has been printed
-                putc( userWord[ i ], stdout );
-                charYellowPrinted = true;
+    /** File the ladder graph is cached in, or NULL */
+    char *graphCache;
 
-                break;
-            }
-        }  
+    /** Whether the list is benchmarked against its Elias-Fano encoding */
+    bool benchEliasFano;
 
-        //if a yellow character was not printed, by process of elimination it is default color
-        if ( !charYellowPrinted ) {
+    /** Number of threads parallel work runs on, or 0 for one per core */
+    int threads;
 
-            //sets current color to default if it isn't already
-            if ( currentColor != defaultColor ) {
-                colorDefault();
-                currentColor = defaultColor;
-            }
+    /** Whether the threads of the pool are pinned to cores */
+    bool pin;
 
-            putc( userWord[ i ], stdout );
-        }
+    /** Whether the scalability of the thread pool is measured */
+    bool benchPool;
 
-    }
+    /** Whether the list is cleaned up before it is checked */
+    bool lenient;
 
-    //make sure to return to default color if last character printed was yellow or green
-    if ( currentColor != defaultColor ) {
-        colorDefault();
-        currentColor = defaultColor;
-    }
+    /** Whether the best next guess is printed after every guess */
+    bool hints;
+
+    /** Whether the game is played with the best guesses instead of read ones */
+    bool autoPlay;
+
+    /** Whether a game against every word is simulated instead of playing */
+    bool simulate;
+
+    /** Most game states the hint cache remembers */
+    long hintCache;
+
+    /** Number of worker processes the simulation is spread across, or 0 for none */
+    int workers;
+
+    /** File the simulation's progress is saved to and resumed from, or NULL */
+    char *checkpoint;
+
+    /** Whether the game is shown full-screen */
+    bool tui;
 
-    //print a line-feed
-    putc( '\n', stdout );
+    /** File a compact record of the game is appended to, or NULL */
+    char *transcript;
+
+    /** Transcript whose games are printed instead of playing, or NULL */
+    char *expand;
+
+    /** Whether guesses must be consistent with the feedback so far */
+    bool hard;
+
+    /** Whether the simulation is benchmarked in normal and hard mode */
+    bool benchHard;
+
+    /** Whether fingerprinting the list is benchmarked */
+    bool benchFingerprint;
+} Options;
+
+/**
+ * Prints the correct usage for the command-line arguments and exits
+ * with system failure
+ */
+static void printUsageError()
+{
+    fprintf( stderr, "usage: wordle [options] <word-list-file> [seed-number]" );
+    exit( EXIT_FAILURE );
 }
 
 /**
@@ -177,6 +234,401 @@ static void getSeed( char *str, long *seed )
     }
 }
 
+/**
+ * Parses a small positive count given as an option value.
+ * Exits with the usage error if it is not a number from 1 to max.
+ * @param str the string being parsed
+ * @param max the largest count allowed
+ * @return int the count
+ */
+static int parseCount( char const *str, int max )
+{
+    int count = 0;
+    for ( int i = 0; str[ i ]; i++ ) {
+        if ( str[ i ] < NUMBER_0 || str[ i ] > NUMBER_9 || count > max )
+            printUsageError();
+        count = count * BASE_10 + ( str[ i ] - NUMBER_0 );
+    }
+
+    if ( count < 1 || count > max )
+        printUsageError();
+
+    return count;
+}
+
+/**
+ * Parses a size in bytes given as an option value, with an optional
+ * K, M or G suffix for kibibytes, mebibytes or gibibytes.
+ * Exits with the usage error if it is not a positive size.
+ * @param str the string being parsed
+ * @return long the size in bytes
+ */
+static long parseSize( char *str )
+{
+    //the digits are parsed the same way as the seed
+    long multiplier = 1;
+    int len = strlen( str );
+    char suffix = len > 0 ? str[ len - 1 ] : NULL_TERMINATOR;
+    if ( suffix == 'K' || suffix == 'M' || suffix == 'G' ) {
+        multiplier = suffix == 'K' ? 1L << 10 : suffix == 'M' ? 1L << 20 : 1L << 30;
+        str[ len - 1 ] = NULL_TERMINATOR;
+    }
+
+    long size;
+    getSeed( str, &size );
+    if ( size < 1 || size > LONG_MAX / multiplier )
+        printUsageError();
+
+    return size * multiplier;
+}
+
+/**
+ * Parses the options at the front of the command-line arguments.
+ * Every option starts with "--", the first argument that does not
+ * is the start of the positional arguments.
+ * @param argc the number of command-line arguments
+ * @param argv the string array holding command-line arguments
+ * @param options where the parsed options are stored
+ * @return int the index of the first positional argument
+ */
+static int parseOptions( int argc, char *argv[], Options *options )
+{
+    //nothing is enabled unless asked for
+    options->metricsSocket = NULL;
+    options->stats = false;
+    options->rankOpeners = false;
+    options->coverWords = 0;
+    options->byFrequency = false;
+    options->sortOutput = NULL;
+    options->memoryCap = DEFAULT_SORT_MEMORY;
+    options->length = 0;
+    options->round = -1;
+    options->complete = false;
+    options->suggest = false;
+    options->ladderFrom = NULL;
+    options->ladderTo = NULL;
+    options->graphCache = NULL;
+    options->benchEliasFano = false;
+    options->threads = 0;
+    options->pin = false;
+    options->benchPool = false;
+    options->lenient = false;
+    options->hints = false;
+    options->autoPlay = false;
+    options->simulate = false;
+    options->hintCache = DEFAULT_HINT_CACHE;
+    options->workers = 0;
+    options->checkpoint = NULL;
+    options->tui = false;
+    options->transcript = NULL;
+    options->expand = NULL;
+    options->hard = false;
+    options->benchHard = false;
+    options->benchFingerprint = false;
+
+    int i = 1;
+    while ( i < argc && strncmp( argv[ i ], "--", 2 ) == 0 ) {
+
+        //options that take a value need one more argument after them
+        if ( strcmp( argv[ i ], "--metrics" ) == 0 && i + 1 < argc ) {
+            options->metricsSocket = argv[ i + 1 ];
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--stats" ) == 0 ) {
+            options->stats = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--rank-openers" ) == 0 ) {
+            options->rankOpeners = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--cover" ) == 0 && i + 1 < argc ) {
+            options->coverWords = parseCount( argv[ i + 1 ], MAX_COVER_WORDS );
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--by-frequency" ) == 0 ) {
+            options->byFrequency = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--external-sort" ) == 0 && i + 1 < argc ) {
+            options->sortOutput = argv[ i + 1 ];
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--memory-cap" ) == 0 && i + 1 < argc ) {
+            options->memoryCap = parseSize( argv[ i + 1 ] );
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--complete" ) == 0 ) {
+            options->complete = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--ladder" ) == 0 && i + 2 < argc ) {
+            options->ladderFrom = argv[ i + 1 ];
+            options->ladderTo = argv[ i + 2 ];
+            i += 3;
+        }
+
+        else if ( strcmp( argv[ i ], "--graph-cache" ) == 0 && i + 1 < argc ) {
+            options->graphCache = argv[ i + 1 ];
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--bench-ef" ) == 0 ) {
+            options->benchEliasFano = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--threads" ) == 0 && i + 1 < argc ) {
+            options->threads = parseCount( argv[ i + 1 ], MAX_POOL_THREADS );
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--pin" ) == 0 ) {
+            options->pin = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--bench-pool" ) == 0 ) {
+            options->benchPool = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--lenient" ) == 0 ) {
+            options->lenient = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--hints" ) == 0 ) {
+            options->hints = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--auto-play" ) == 0 ) {
+            options->autoPlay = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--simulate" ) == 0 ) {
+            options->simulate = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--hint-cache" ) == 0 && i + 1 < argc ) {
+            options->hintCache = parseSize( argv[ i + 1 ] );
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--workers" ) == 0 && i + 1 < argc ) {
+            options->workers = parseCount( argv[ i + 1 ], MAX_SIM_WORKERS );
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--checkpoint" ) == 0 && i + 1 < argc ) {
+            options->checkpoint = argv[ i + 1 ];
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--tui" ) == 0 ) {
+            options->tui = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--transcript" ) == 0 && i + 1 < argc ) {
+            options->transcript = argv[ i + 1 ];
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--expand" ) == 0 && i + 1 < argc ) {
+            options->expand = argv[ i + 1 ];
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--hard" ) == 0 ) {
+            options->hard = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--bench-hard" ) == 0 ) {
+            options->benchHard = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--bench-fingerprint" ) == 0 ) {
+            options->benchFingerprint = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--suggest" ) == 0 ) {
+            options->suggest = true;
+            i++;
+        }
+
+        else if ( strcmp( argv[ i ], "--round" ) == 0 && i + 1 < argc ) {
+            getSeed( argv[ i + 1 ], &options->round );
+            i += 2;
+        }
+
+        else if ( strcmp( argv[ i ], "--length" ) == 0 && i + 1 < argc ) {
+            options->length = parseCount( argv[ i + 1 ], MAX_WORD_LEN );
+            i += 2;
+        }
+
+        else
+            printUsageError();
+    }
+
+    return i;
+}
+
+/**
+ * Prints the allocation statistics to stderr. Registered with atexit
+ * so they are printed however the game ends.
+ */
+static void reportStats()
+{
+    printAllocStats( stderr );
+}
+
+/**
+ * Gets the solver ready for the sorted list, exiting with an error if the
+ * list is too long to index.
+ * @param options the parsed command-line options
+ */
+static void startSolver( Options const *options )
+{
+    if ( !prepareSolver( options->hintCache, options->hard ) ) {
+        fprintf( stderr, "The word list is empty or too long for the solver\n" );
+        exit( EXIT_FAILURE );
+    }
+}
+
+/**
+ * Runs the analysis mode asked for in the options, if any, on the
+ * sorted list of words of the chosen length.
+ * @param options the parsed command-line options
+ * @return true if an analysis was run and no game should be played
+ * @return false if else
+ */
+static bool runAnalysis( Options const *options )
+{
+    if ( options->benchPool ) {
+        benchmarkPool( stdout, options->pin );
+        return true;
+    }
+
+    //parallel analyses share one pool, which starts itself one thread per
+    //core unless it was sized or pinned here first
+    if ( options->threads > 0 || options->pin )
+        startPool( options->threads, options->pin );
+
+    //ranking and covering score words of the standard length only
+    if ( ( options->rankOpeners || options->coverWords > 0 ) && wordLength() != WORD_LEN ) {
+        fprintf( stderr, "Openers and covers are only found for words of length %d\n", WORD_LEN );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( options->rankOpeners ) {
+        if ( !rankOpeners( stdout, options->hard ) ) {
+            fprintf( stderr, "The word list is too long to rank in hard mode\n" );
+            exit( EXIT_FAILURE );
+        }
+        return true;
+    }
+
+    if ( options->coverWords > 0 ) {
+        searchCover( stdout, options->coverWords, options->byFrequency );
+        return true;
+    }
+
+    if ( options->ladderFrom != NULL ) {
+        //the ladder uses the words of the same length as its first word
+        if ( !selectLength( strlen( options->ladderFrom ) ) ) {
+            fprintf( stderr, "No words of the length of %s in the word list\n", options->ladderFrom );
+            exit( EXIT_FAILURE );
+        }
+        prepareLadder( options->graphCache );
+        if ( !printLadder( stdout, options->ladderFrom, options->ladderTo ) )
+            exit( EXIT_FAILURE );
+        return true;
+    }
+
+    if ( options->simulate ) {
+        startSolver( options );
+        if ( options->workers > 0 )
+            simulateWithWorkers( stdout, options->workers, options->checkpoint );
+        else
+            simulateGames( stdout, options->checkpoint );
+        return true;
+    }
+
+    if ( options->benchHard ) {
+        startSolver( options );
+        benchmarkHardMode( stdout );
+        return true;
+    }
+
+    if ( options->expand != NULL ) {
+        expandTranscript( options->expand );
+        return true;
+    }
+
+    if ( options->benchFingerprint ) {
+        benchmarkFingerprint( stdout );
+        return true;
+    }
+
+    if ( options->benchEliasFano ) {
+        benchmarkEliasFano( stdout );
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Writes out the valid words closest to a guess that is not in the list,
+ * if any are close enough.
+ * @param userWord the rejected guess, of the right length and letters
+ * @param text where the line is stored, with room for MESSAGE_LINE_LEN characters
+ * @return true if any words were close enough
+ * @return false if else
+ */
+static bool formatSuggestions( char const userWord[], char text[] )
+{
+    int found[ MAX_SUGGESTIONS ];
+    int count = suggestWords( userWord, found );
+    if ( count == 0 )
+        return false;
+
+    int len = sprintf( text, "Did you mean" );
+    for ( int i = 0; i < count; i++ )
+        len += sprintf( text + len, "%s %s", i == 0 ? ":" : ",", lexiconWord( found[ i ] ) );
+    sprintf( text + len, "?" );
+    return true;
+}
+
+/**
+ * Process the user's guess using the provided rules of wordle.
+ * Prints each character in the user's guess in the appropriate color.
+ * @param userWord The word that the user guessed
+ * @param targetWord The target word in this game of wordle
+ *        precondtion: Both userWord and targetWord are valid words from the wordList
+ */
+static void processWord( char userWord[], char targetWord[] )
+{    
+    //the feedback code holds the color of every letter, green letters
+    //first and then yellow letters tied one-to-one to target letters
+    printFeedback( userWord, feedbackCodeOfLength( userWord, targetWord, wordLength() ) );
+}
+
 /**
  * Starting point of the wordle game. Houses nearly all 
  * the game logic, including game-loops. Also properly handles 
@@ -189,35 +641,96 @@ static void getSeed( char *str, long *seed )
 int main( int argc, char *argv[] )
 {
 
-    // check for proper usage
-    if ( argc < FILE_ARG_INDEX + 1 || argc > SEED_ARG_INDEX + 1 )
+    // parse the options, then check for proper usage of the remaining arguments
+    Options options;
+    int first = parseOptions( argc, argv, &options );
+    char **args = argv + first;
+    int numArgs = argc - first;
+    if ( numArgs < FILE_ARG_INDEX + 1 || numArgs > SEED_ARG_INDEX + 1 )
         printUsageError();
 
-    // read in the list of words using the 1st command-line argument
-    readWords( argv[ FILE_ARG_INDEX ] );
+    // start serving metrics before anything is counted
+    if ( options.metricsSocket != NULL && !serveMetrics( options.metricsSocket ) ) {
+        fprintf( stderr, "Can't serve metrics on: %s\n", options.metricsSocket );
+        exit( EXIT_FAILURE );
+    }
+
+    if ( options.stats )
+        atexit( reportStats );
+
+    // the external sort streams the list itself, it may not fit in memory
+    if ( options.sortOutput != NULL ) {
+        externalSort( args[ FILE_ARG_INDEX ], options.sortOutput, options.memoryCap, options.lenient );
+        exit( EXIT_SUCCESS );
+    }
+
+    // read in the list of words using the 1st positional argument through the
+    // registry, cleaning it up first if asked to, and allowing words of other
+    // lengths only if a length was asked for; the lexicon is shared as it is,
+    // and the game's own choices are kept in its session until it exits
+    static Session session;
+    setLenient( options.lenient );
+    openSession( &session, acquireLexicon( args[ FILE_ARG_INDEX ], options.length > 0 ) );
+    useSession( &session );
+
+    // play with the words of the length asked for, the standard length otherwise
+    if ( options.length > 0 && !selectLength( options.length ) ) {
+        fprintf( stderr, "No words of length %d in the word list\n", options.length );
+        exit( EXIT_FAILURE );
+    }
+
+    // analysis modes work on the words of that length and do not play a game
+    if ( runAnalysis( &options ) )
+        exit( EXIT_SUCCESS );
+    int len = wordLength();
 
     // initialize seed used for random word picking
     long seed;
 
     // if the user provided a seed, scan it
-    if ( argc == SEED_ARG_INDEX + 1 )
-        getSeed( argv[ SEED_ARG_INDEX ], &seed );
+    if ( numArgs == SEED_ARG_INDEX + 1 )
+        getSeed( args[ SEED_ARG_INDEX ], &seed );
 
     // if not, generate seed using time
     else
         seed = time( NULL );
 
-    // pick a random target word from the list of words
-    char targetWord [ WORD_LEN + 1 ];
-    chooseWord( seed, targetWord );
+    // pick a random target word from the list of words, or the
+    // word of the round asked for from the seed's schedule
+    char targetWord [ MAX_WORD_LEN + 1 ];
+    if ( options.round >= 0 )
+        chooseScheduledWord( seed, options.round, targetWord );
+    else
+        chooseWord( seed, targetWord );
+    countMetric( METRIC_GAMES_STARTED );
+    TRACE2( game_start, targetWord, seed );
 
     //initialize and keep track of the user's number of guesses and 
     //initialize the pointer to the user's guess
     int numValidGuesses = 0;
-    char userWord[ WORD_LEN + 1 ];
+    char userWord[ MAX_WORD_LEN + 1 ];
+
+    //completion needs the sorted list, and only works at a terminal
+    bool completing = options.complete && startCompletion();
+
+    //suggestions scan a packed copy of the sorted list
+    if ( options.suggest )
+        prepareSuggestions();
+
+    //hints and auto-play keep the candidates left with the feedback index
+    if ( options.hints || options.autoPlay )
+        startSolver( &options );
+
+    //the transcript is opened before the game so recording never allocates
+    if ( options.transcript != NULL && !startTranscript( options.transcript, seed ) )
+        exit( EXIT_FAILURE );
 
-    //alphabetically sort the list of words to make word look ups faster
-    sort();
+    //the full-screen view replaces the colored lines
+    if ( options.tui )
+        startScreen();
+
+    //everything the game needs has been allocated, the loops below must not allocate
+    beginSteadyState();
 
     //continute to get valid guesses until the user guesses the word. 
     //This is the main game loop, where each loop represents every valid guess
@@ -235,23 +748,42 @@ int main( int argc, char *argv[] )
         while ( !wordIsValid ) { 
 
             //initialize (or reinitialize) userWord, userWordLen, and wordIsValid
-            for ( int i = 0; i < WORD_LEN; i++ ) 
+            for ( int i = 0; i <= len; i++ ) 
                 userWord[ i ] = NULL_TERMINATOR;
             int userWordLen = 0;
 
             //assume the guess is valid everytime and try to prove that it is not
             wordIsValid = true;
 
+            //the view catches up with the last guess before the next one
+            if ( options.tui )
+                refreshScreen();
+
+            //auto-play makes the best guess instead of reading one, the
+            //full-screen view shows it on the board
+            if ( options.autoPlay ) {
+                strcpy( userWord, lexiconWord( suggestGuess() ) );
+                if ( !options.tui )
+                    fprintf( stdout, "%s\n", userWord );
+                break;
+            }
+
             //read the word in character by character until a new line or EOF
+            //the whole line is checked against the quit command as it goes, since
+            //only len letters of it are kept and words may be shorter than the command
             char letter;
-            while ( ( letter = getc( stdin ) ) != '\n' && letter != EOF && letter != '\r' ) {
+            bool typedQuit = true;
+            while ( ( letter = completing ? completedGetc() : getc( stdin ) ) != '\n' && letter != EOF && letter != '\r' ) {
+
+                if ( userWordLen >= strlen( QUIT_COMMAND ) || letter != QUIT_COMMAND[ userWordLen ] )
+                    typedQuit = false;
 
                 //if character is not valid, then flag as invalid
                 if ( letter < LOWERCASE_A || letter > LOWERCASE_Z )
                     wordIsValid = false;
 
                 //concatenate the letter to the word only if within the bounds of the userWord array
-                if ( userWordLen < WORD_LEN )
+                if ( userWordLen < len )
                     userWord[ userWordLen ] = letter;
 
                 //continue to increment userWordLen anyway for later error-checking
@@ -260,23 +792,38 @@ int main( int argc, char *argv[] )
             }
 
             //if reached EOF or if user input "quit", then quit and output the targetWord
-            if ( letter == EOF || strcmp( "quit", userWord ) == 0 ) {
+            if ( letter == EOF || ( typedQuit && userWordLen == strlen( QUIT_COMMAND ) ) ) {
+                finishTranscript( false, targetWord );
+                endScreen();
                 fprintf( stdout, "The word was \"%s\"\n", targetWord );
                 exit( EXIT_SUCCESS );
             }
 
             //if userWord is not correct length, it is invalid
-            if ( userWordLen != WORD_LEN )
+            if ( userWordLen != len )
                 wordIsValid = false;
 
             //set wordIsValid to the intersection of it and the word being in the list
             //this shortcircuits if the word is already found to be invalid, slightly 
             //improving efficiency
+            bool wellFormed = wordIsValid;
             wordIsValid = wordIsValid && inList( userWord );
 
             //if word is invalid, output that it is invalid
-            if ( !wordIsValid )
-                fprintf( stdout, "Invalid guess\n" );
+            if ( !wordIsValid ) {
+                countMetric( METRIC_INVALID_GUESSES );
+
+                //a word of the right letters can be compared with the list
+                char suggestions[ MESSAGE_LINE_LEN ];
+                bool suggested = options.suggest && wellFormed && formatSuggestions( userWord, suggestions );
+                if ( options.tui ) {
+                    screenStatus( SCREEN_MESSAGE, suggested ? suggestions : "Invalid guess" );
+                } else {
+                    fprintf( stdout, "Invalid guess\n" );
+                    if ( suggested )
+                        fprintf( stdout, "%s\n", suggestions );
+                }
+            }
 
         }
 
@@ -285,16 +832,45 @@ int main( int argc, char *argv[] )
 
         //process the word only if it is incorrect
         //(We do not print an all-green correct guess)
-        if ( !guessIsCorrect )
+        //the full-screen view puts every guess on the board instead
+        if ( options.tui ) {
+            screenGuess( userWord, feedbackCodeOfLength( userWord, targetWord, len ) );
+            screenStatus( SCREEN_MESSAGE, "" );
+        } else if ( !guessIsCorrect ) {
             processWord( userWord, targetWord );
+        }
+
+        recordGuess( userWord, feedbackCodeOfLength( userWord, targetWord, len ) );
+
+        //narrow the candidates by the feedback and hint at the best next guess
+        if ( !guessIsCorrect && ( options.hints || options.autoPlay ) ) {
+            narrowByGuess( userWord, feedbackCodeOfLength( userWord, targetWord, len ) );
+            if ( options.hints ) {
+                char hint[ MESSAGE_LINE_LEN ];
+                snprintf( hint, sizeof( hint ), "Hint: %s, %d word%s left", lexiconWord( suggestGuess() ), remainingCandidates(),
+                          remainingCandidates() == 1 ? "" : "s" );
+                if ( options.tui )
+                    screenStatus( SCREEN_HINT, hint );
+                else
+                    fprintf( stdout, "%s\n", hint );
+            }
+        }
 
         //keep track of the number of valid guesses
         numValidGuesses++;
+        countMetric( METRIC_GUESSES );
 
     } 
 
     //user has now guessed the correct word. 
     //print their number of guesses and update and print their score records
+    finishTranscript( true, targetWord );
+    if ( options.tui ) {
+        screenStatus( SCREEN_HINT, "" );
+        endScreen();
+    }
+    countMetric( METRIC_GAMES_FINISHED );
+    TRACE2( game_end, targetWord, numValidGuesses );
     fprintf( stdout, numValidGuesses == 1 ? "Solved in %d guess\n" : "Solved in %d guesses\n", numValidGuesses );
     updateScore( numValidGuesses );
 